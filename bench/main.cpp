@@ -2,10 +2,20 @@
 
 #include <tt/sort.hpp>
 
+#include "perf_counters.hpp"
+
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 template <std::uniform_random_bit_generator G = std::mt19937>
 constexpr auto
@@ -23,7 +33,11 @@ radix_sort(benchmark::State& state)
     auto seq{ rndseq(state.range(0)) };
     decltype(seq) res{ seq };
 
+    perf_counters counters;
+    counters.start();
     for (auto _ : state) tt::radix_sort(seq, begin(res));
+    counters.stop();
+    counters.report(state, state.iterations() * size(res));
 
     assert(std::ranges::is_sorted(res));
     state.SetItemsProcessed(size(res));
@@ -37,7 +51,11 @@ std_sort(benchmark::State& state)
     auto seq{ rndseq(state.range(0)) };
     decltype(seq) res{ seq };
 
+    perf_counters counters;
+    counters.start();
     for (auto _ : state) std::ranges::sort(seq);
+    counters.stop();
+    counters.report(state, state.iterations() * size(res));
 
     assert(std::ranges::is_sorted(seq));
     state.SetItemsProcessed(size(res));
@@ -54,7 +72,11 @@ counting_sort(benchmark::State& state)
     std::vector seq(begin(seqview), end(seqview));
     std::vector res(begin(seq), end(seq));
 
+    perf_counters counters;
+    counters.start();
     for (auto _ : state) tt::counting_sort(seq, begin(res));
+    counters.stop();
+    counters.report(state, state.iterations() * size(res));
 
     assert(std::ranges::is_sorted(res));
     state.SetItemsProcessed(size(res));
@@ -62,4 +84,270 @@ counting_sort(benchmark::State& state)
 }
 BENCHMARK(counting_sort)->RangeMultiplier(2)->Range(0, 1000000);
 
+/*
+    Realistic shapes of input, sorted by all algorithms.
+
+    Element is either bare 64-bit key, or record with key and payload,
+    so the same keys can be sorted as elements of 8 to 128 bytes.
+    Input is copied to work buffer in each iteration, because all algorithms change it,
+    so the copy is included in time of each of them equally.
+    `counting_sort` is skipped, if range of keys is too wide for its table.
+*/
+enum class distribution
+{
+    // the whole 64-bit range
+    uniform,
+    // ids 0..2^20, the most popular ones appear much more often (s = 1)
+    zipf,
+    // nanosecond timestamps, which grow by 0..7, with 1% of them swapped with neighbours
+    mostly_sorted,
+    // 16 distinct small values, e.g. enum
+    few_unique,
+    // 64-bit keys from narrow window [base, base + 2^20), e.g. ids with common prefix
+    narrow_range,
+};
+
+enum class algorithm
+{
+    radix_sort,
+    counting_sort,
+    std_sort,
+};
+
+constexpr std::uint64_t counting_sort_max_range{ 1 << 24 };
+constexpr std::uint64_t timestamp_base{ 1'700'000'000'000'000'000 };
+
+std::vector<std::uint64_t>
+zipf_keys(std::size_t size, std::mt19937_64& engine)
+{
+    constexpr std::size_t universe{ 1 << 20 };
+
+    // inverse transform sampling by cumulative distribution of ranks
+    std::vector<double> cdf(universe);
+    double sum{ 0 };
+    for (std::size_t rank{ 0 }; rank < universe; ++rank)
+    {
+        sum += 1.0 / static_cast<double>(rank + 1);
+        cdf[rank] = sum;
+    }
+
+    std::uniform_real_distribution<double> uniform{ 0, sum };
+    std::vector<std::uint64_t> keys(size);
+    for (auto& k : keys) k = std::ranges::lower_bound(cdf, uniform(engine)) - cdf.begin();
+    return keys;
+}
+
+std::vector<std::uint64_t>
+make_keys(distribution dist, std::size_t size, std::uint64_t seed = std::mt19937_64::default_seed)
+{
+    std::mt19937_64 engine{ seed };
+    std::vector<std::uint64_t> keys(size);
+
+    switch (dist)
+    {
+    case distribution::uniform:
+        std::ranges::generate(keys, engine);
+        break;
+
+    case distribution::zipf:
+        keys = zipf_keys(size, engine);
+        break;
+
+    case distribution::mostly_sorted:
+    {
+        std::uint64_t t{ timestamp_base };
+        for (auto& k : keys) k = t += engine() % 8;
+        for (std::size_t i{ 0 }; i + 1 < size; ++i)
+            if (engine() % 100 == 0) std::swap(keys[i], keys[i + 1]);
+        break;
+    }
+
+    case distribution::few_unique:
+        for (auto& k : keys) k = engine() % 16;
+        break;
+
+    case distribution::narrow_range:
+        for (auto& k : keys) k = timestamp_base + engine() % (1 << 20);
+        break;
+    }
+    return keys;
+}
+
+template <std::size_t Size>
+struct record
+{
+    std::uint64_t key;
+    std::array<std::byte, Size - sizeof(key)> payload;
+};
+
+// bare key for 8 bytes, so it's the same as sorting of plain integers
+template <std::size_t Size>
+using element = std::conditional_t<Size == sizeof(std::uint64_t), std::uint64_t, record<Size>>;
+
+struct key_of
+{
+    std::uint64_t
+    operator()(std::uint64_t k) const noexcept
+    {
+        return k;
+    }
+
+    template <std::size_t Size>
+    std::uint64_t
+    operator()(record<Size> const& r) const noexcept
+    {
+        return r.key;
+    }
+};
+
+template <std::size_t Size>
+std::vector<element<Size>>
+make_input(distribution dist, std::size_t size)
+{
+    std::vector<std::uint64_t> const keys{ make_keys(dist, size) };
+    std::vector<element<Size>> input(size);
+    for (std::size_t i{ 0 }; i < size; ++i)
+    {
+        if constexpr (std::same_as<element<Size>, std::uint64_t>)
+        {
+            input[i] = keys[i];
+        } else
+        {
+            input[i].key = keys[i];
+            input[i].payload.fill(static_cast<std::byte>(i));
+        }
+    }
+    return input;
+}
+
+template <std::size_t Size>
+void
+sort_distribution(benchmark::State& state, algorithm algo, distribution dist)
+{
+    auto const size{ static_cast<std::size_t>(state.range(0)) };
+    std::vector<element<Size>> const input{ make_input<Size>(dist, size) };
+    std::vector<element<Size>> seq(size);
+    std::vector<element<Size>> res(size);
+
+    auto const [min, max]{ std::ranges::minmax(input | std::views::transform(key_of{})) };
+    if (algo == algorithm::counting_sort && max - min >= counting_sort_max_range)
+    {
+        state.SkipWithError("key range is too wide for counting_sort");
+        return;
+    }
+
+    perf_counters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        std::ranges::copy(input, seq.begin());
+        switch (algo)
+        {
+        case algorithm::radix_sort:
+            tt::radix_sort(seq, res.begin(), std::identity{}, key_of{});
+            break;
+        case algorithm::counting_sort:
+            tt::counting_sort(
+                seq, res.begin(), max - min, [min](std::uint64_t k) { return k - min; }, key_of{});
+            break;
+        case algorithm::std_sort:
+            std::ranges::sort(seq, std::less{}, key_of{});
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    counters.stop();
+    counters.report(state, state.iterations() * size);
+
+    assert(std::ranges::is_sorted(algo == algorithm::std_sort ? seq : res, std::less{}, key_of{}));
+    state.SetItemsProcessed(state.iterations() * size);
+    state.SetBytesProcessed(state.iterations() * size * Size);
+    state.counters["array_size"] = size;
+}
+
+template <std::size_t Size>
+void
+register_distributions()
+{
+    constexpr std::pair<char const*, algorithm> algorithms[]{
+        { "radix_sort", algorithm::radix_sort },
+        { "counting_sort", algorithm::counting_sort },
+        { "std_sort", algorithm::std_sort },
+    };
+    constexpr std::pair<char const*, distribution> distributions[]{
+        { "uniform", distribution::uniform },
+        { "zipf", distribution::zipf },
+        { "mostly_sorted", distribution::mostly_sorted },
+        { "few_unique", distribution::few_unique },
+        { "narrow_range", distribution::narrow_range },
+    };
+
+    for (auto const& [dist_name, dist] : distributions)
+    {
+        for (auto const& [algo_name, algo] : algorithms)
+        {
+            std::string const name{ std::string{ algo_name } + "/" + dist_name + "/" +
+                                    std::to_string(Size) + "B" };
+            benchmark::RegisterBenchmark(name.c_str(), sort_distribution<Size>, algo, dist)
+                ->RangeMultiplier(16)
+                ->Range(1 << 10, 1 << 18);
+        }
+    }
+}
+
+[[maybe_unused]] bool const distributions_registered{ [] {
+    register_distributions<8>();
+    register_distributions<16>();
+    register_distributions<32>();
+    register_distributions<64>();
+    register_distributions<128>();
+    return true;
+}() };
+
+/*
+    Where time of `radix_sort` goes at each input size:
+    nanoseconds per element and share of total time of each phase, summed over all passes.
+*/
+template <std::size_t Size>
+void
+radix_sort_phases(benchmark::State& state)
+{
+    auto const size{ static_cast<std::size_t>(state.range(0)) };
+    std::vector<element<Size>> const input{ make_input<Size>(distribution::uniform, size) };
+    std::vector<element<Size>> seq(size);
+    std::vector<element<Size>> res(size);
+
+    tt::sort_phase_timings timings;
+    for (auto _ : state)
+    {
+        std::ranges::copy(input, seq.begin());
+        tt::radix_sort(seq, res.begin(), std::identity{}, key_of{},
+                       tt::byte_radix_traits<std::uint64_t>{}, timings);
+        benchmark::ClobberMemory();
+    }
+    assert(std::ranges::is_sorted(res, std::less{}, key_of{}));
+
+    constexpr std::pair<char const*, tt::sort_phase> phases[]{
+        { "histogram", tt::sort_phase::histogram },
+        { "prefix_sum", tt::sort_phase::prefix_sum },
+        { "scatter", tt::sort_phase::scatter },
+        { "copy_back", tt::sort_phase::copy_back },
+    };
+
+    std::chrono::nanoseconds total{ 0 };
+    for (auto const& [_, phase] : phases) total += timings.total(phase).time;
+
+    auto const elements{ static_cast<double>(state.iterations() * size) };
+    for (auto const& [name, phase] : phases)
+    {
+        auto const time{ static_cast<double>(timings.total(phase).time.count()) };
+        state.counters[std::string{ name } + "_ns/elem"] = time / elements;
+        state.counters[std::string{ name } + "_%"] = 100 * time / total.count();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+    state.counters["array_size"] = size;
+}
+BENCHMARK_TEMPLATE(radix_sort_phases, 8)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(radix_sort_phases, 64)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+
 BENCHMARK_MAIN();
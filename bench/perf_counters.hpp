@@ -0,0 +1,164 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+    Hardware counters of the calling thread read through `perf_event_open`.
+
+    ```
+        perf_counters counters;
+        counters.start();
+        for (auto _ : state) sort(...);
+        counters.stop();
+        counters.report(state, state.iterations() * size);
+    ```
+
+    Each event is opened separately, so if CPU (or VM) doesn't support some of them,
+    the rest are still counted. If none can be opened (no PMU, `perf_event_paranoid` is 3,
+    seccomp of container), nothing is reported and benchmark runs as usual.
+    Only user space is counted, this is allowed with default `perf_event_paranoid` 2.
+    When there are more events than hardware counters, kernel multiplexes them
+    and values are scaled by time each event was really counted.
+*/
+class perf_counters
+{
+public:
+    perf_counters()
+    {
+        for (std::size_t i{ 0 }; i < events.size(); ++i) m_fds[i] = open(events[i]);
+    }
+
+    perf_counters(perf_counters const&) = delete;
+    perf_counters& operator=(perf_counters const&) = delete;
+
+    ~perf_counters()
+    {
+        for (int fd : m_fds)
+            if (fd >= 0) ::close(fd);
+    }
+
+    ///! true, if at least one counter is opened
+    bool
+    available() const noexcept
+    {
+        for (int fd : m_fds)
+            if (fd >= 0) return true;
+        return false;
+    }
+
+    ///! resets and starts all counters
+    void
+    start() noexcept
+    {
+        for (int fd : m_fds)
+        {
+            if (fd < 0) continue;
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void
+    stop() noexcept
+    {
+        for (int fd : m_fds)
+            if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    ///! adds counters divided by `elements` to benchmark output,
+    ///! i.e. `cycles/elem`, `L1D-miss/elem`
+    void
+    report(benchmark::State& state, std::uint64_t elements) const
+    {
+        if (elements == 0) return;
+
+        for (std::size_t i{ 0 }; i < events.size(); ++i)
+        {
+            std::uint64_t value{ 0 };
+            if (!read(m_fds[i], value)) continue;
+            state.counters[events[i].name] = static_cast<double>(value) / elements;
+        }
+    }
+
+private:
+    struct event
+    {
+        char const* name;
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    // config of PERF_TYPE_HW_CACHE is cache id | operation << 8 | result << 16
+    static constexpr std::uint64_t read_miss{ (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) };
+
+    static constexpr std::array<event, 6> events{ {
+        { "cycles/elem", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "instructions/elem", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "L1D-miss/elem", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | read_miss },
+        { "LLC-miss/elem", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | read_miss },
+        { "dTLB-miss/elem", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | read_miss },
+        { "branch-miss/elem", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    } };
+
+    static int
+    open(event const& e) noexcept
+    {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = e.type;
+        attr.config = e.config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // this thread on any CPU
+        int const fd{ static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)) };
+        if (fd < 0) warn_once(e.name);
+        return fd;
+    }
+
+    static bool
+    read(int fd, std::uint64_t& value) noexcept
+    {
+        if (fd < 0) return false;
+
+        // value, time enabled, time running
+        std::array<std::uint64_t, 3> buf{};
+        if (::read(fd, buf.data(), sizeof(buf)) != sizeof(buf) || buf[2] == 0) return false;
+
+        value = buf[0];
+        if (buf[2] < buf[1])
+            value = static_cast<std::uint64_t>(static_cast<double>(value) * buf[1] / buf[2]);
+        return true;
+    }
+
+    static void
+    warn_once(char const* name) noexcept
+    {
+        // reason is the same for each benchmark, so print it once per event
+        static std::array<bool, events.size()> warned{};
+        for (std::size_t i{ 0 }; i < events.size(); ++i)
+        {
+            if (events[i].name != name || warned[i]) continue;
+            warned[i] = true;
+            std::fprintf(stderr, "perf counter %s is unavailable: %s\n", name,
+                         std::strerror(errno));
+        }
+    }
+
+    std::array<int, events.size()> m_fds{};
+};
@@ -0,0 +1,169 @@
+#include <benchmark/benchmark.h>
+
+#include <tt/pool_allocator.hpp>
+#include <tt/thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <vector>
+
+/*
+    Fork-join workloads for `tt::thread_pool`.
+    Each is compared with the serial version, so the speedup is visible directly.
+*/
+
+namespace
+{
+
+// below this `n` fib is computed serially, otherwise tasks are too small to pay for themselves
+int const fib_cutoff{ 12 };
+
+long
+fib_serial(int n)
+{
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+long
+fib_parallel(tt::thread_pool& pool, int n)
+{
+    if (n < fib_cutoff) return fib_serial(n);
+
+    long a{ 0 };
+    long b{ 0 };
+    pool.parallel_invoke([&] { a = fib_parallel(pool, n - 1); },
+                         [&] { b = fib_parallel(pool, n - 2); });
+    return a + b;
+}
+
+void
+work(double& x)
+{
+    x = std::sqrt(x * x + 1.0);
+}
+
+} // namespace
+
+void
+fib_serial(benchmark::State& state)
+{
+    for (auto _ : state) benchmark::DoNotOptimize(fib_serial(static_cast<int>(state.range(0))));
+}
+BENCHMARK(fib_serial)->DenseRange(20, 30, 5);
+
+void
+fib_thread_pool(benchmark::State& state)
+{
+    tt::thread_pool pool;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fib_parallel(pool, static_cast<int>(state.range(0))));
+    state.counters["threads"] = pool.threads_count();
+}
+BENCHMARK(fib_thread_pool)->DenseRange(20, 30, 5)->UseRealTime();
+
+void
+for_each_serial(benchmark::State& state)
+{
+    std::vector<double> v(state.range(0), 1.0);
+    for (auto _ : state)
+    {
+        std::ranges::for_each(v, work);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(for_each_serial)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+// recursive splitting, halves are stolen by idle workers
+void
+for_each_thread_pool(benchmark::State& state)
+{
+    tt::thread_pool pool;
+    std::vector<double> v(state.range(0), 1.0);
+    for (auto _ : state)
+    {
+        pool.parallel_for_each(v.begin(), v.end(), work, 1024);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(for_each_thread_pool)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->UseRealTime();
+
+// the same chunks, but all go through one shared queue, like in a job system with global queue
+void
+for_each_global_queue(benchmark::State& state)
+{
+    tt::thread_pool pool;
+    std::vector<double> v(state.range(0), 1.0);
+    std::size_t const grain{ 1024 };
+    for (auto _ : state)
+    {
+        for (std::size_t first{ 0 }; first < v.size(); first += grain)
+        {
+            pool.submit(
+                [&v, first, grain]
+                {
+                    auto const begin{ v.begin() + first };
+                    std::for_each(begin, begin + std::min(grain, v.size() - first), work);
+                });
+        }
+        pool.wait();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(for_each_global_queue)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->UseRealTime();
+
+/*
+    Churn of per-frame messages: each thread allocates a frame of nodes and frees them all,
+    with `std::allocator` and with `tt::pool_allocator`.
+*/
+struct message
+{
+    char payload[48];
+};
+
+constexpr int frame_messages{ 64 };
+
+template <typename Alloc>
+void
+message_churn(benchmark::State& state, Alloc const& alloc)
+{
+    std::list<message, Alloc> frame{ alloc };
+    for (auto _ : state)
+    {
+        for (int i{ 0 }; i < frame_messages; ++i) frame.emplace_back();
+        benchmark::DoNotOptimize(frame.back());
+        frame.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * frame_messages);
+}
+
+void
+message_churn_std_allocator(benchmark::State& state)
+{
+    message_churn(state, std::allocator<message>{});
+}
+BENCHMARK(message_churn_std_allocator)->ThreadRange(1, 8)->UseRealTime();
+
+void
+message_churn_pool_allocator(benchmark::State& state)
+{
+    // enough for frames and thread caches of 8 threads, it's shared by all runs
+    static tt::block_pool pool{ 64, 8 * 2 * frame_messages };
+
+    message_churn(state, tt::pool_allocator<message>{ pool });
+
+    if (state.thread_index() == 0)
+    {
+        auto const stats{ pool.get_stats() };
+        state.counters["hit_ratio"] =
+            static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+    }
+}
+BENCHMARK(message_churn_pool_allocator)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
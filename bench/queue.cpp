@@ -0,0 +1,813 @@
+#include <benchmark/benchmark.h>
+
+#include <tt/lock_free_ringbuf.hpp>
+#include <tt/multicast_ringbuf.hpp>
+#include <tt/ringbuf.hpp>
+#include <tt/sharded_queue.hpp>
+#include <tt/shm_ringbuf.hpp>
+#include <tt/spsc_ringbuf.hpp>
+#include <tt/triple_buffer.hpp>
+#include <tt/unbounded_queue.hpp>
+#include <tt/wait.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+    FIFO throughput: push `n` elements, then pop them all.
+    Growable ringbuf starts with zero capacity, like a fresh std::deque,
+    so reallocations are included in measurement.
+*/
+template <typename Queue>
+void
+fifo_burst(benchmark::State& state, auto&&... ctor_args)
+{
+    auto const n{ static_cast<std::size_t>(state.range(0)) };
+
+    for (auto _ : state)
+    {
+        Queue q(ctor_args...);
+        for (std::size_t i{ 0 }; i < n; ++i) q.push_back(static_cast<int>(i));
+        for (std::size_t i{ 0 }; i < n; ++i)
+        {
+            benchmark::DoNotOptimize(q.front());
+            q.pop_front();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["queue_size"] = n;
+}
+
+/*
+    Steady state: queue keeps `n` elements, each iteration pushes one and pops one.
+ */
+template <typename Queue>
+void
+fifo_steady(benchmark::State& state, auto&&... ctor_args)
+{
+    auto const n{ static_cast<std::size_t>(state.range(0)) };
+
+    Queue q(ctor_args...);
+    for (std::size_t i{ 0 }; i < n; ++i) q.push_back(static_cast<int>(i));
+
+    for (auto _ : state)
+    {
+        q.push_back(42);
+        benchmark::DoNotOptimize(q.front());
+        q.pop_front();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["queue_size"] = n;
+}
+
+using growable_ringbuf = tt::ringbuf<int, std::allocator<int>, tt::overflow::grow>;
+
+// ringbuf::pop_front returns the element, so give it the same interface as std::deque
+struct ringbuf_fifo : growable_ringbuf
+{
+    ringbuf_fifo()
+        : growable_ringbuf(0)
+    {
+    }
+
+    void
+    pop_front()
+    {
+        (void)discard_front(1);
+    }
+};
+
+void
+ringbuf_grow_fifo_burst(benchmark::State& state)
+{
+    fifo_burst<ringbuf_fifo>(state);
+}
+BENCHMARK(ringbuf_grow_fifo_burst)->RangeMultiplier(8)->Range(8, 1 << 21);
+
+void
+std_deque_fifo_burst(benchmark::State& state)
+{
+    fifo_burst<std::deque<int>>(state);
+}
+BENCHMARK(std_deque_fifo_burst)->RangeMultiplier(8)->Range(8, 1 << 21);
+
+void
+ringbuf_grow_fifo_steady(benchmark::State& state)
+{
+    fifo_steady<ringbuf_fifo>(state);
+}
+BENCHMARK(ringbuf_grow_fifo_steady)->RangeMultiplier(8)->Range(8, 1 << 21);
+
+void
+std_deque_fifo_steady(benchmark::State& state)
+{
+    fifo_steady<std::deque<int>>(state);
+}
+BENCHMARK(std_deque_fifo_steady)->RangeMultiplier(8)->Range(8, 1 << 21);
+
+/*
+    MPMC: each thread pushes one element and pops one element, so queue is shared by all of them.
+    Throughput is counted in operations (push or pop) per second of real time.
+*/
+using mpmc_ringbuf = tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::reject_newest>;
+std::unique_ptr<mpmc_ringbuf> mpmc_queue;
+
+void
+lock_free_ringbuf_mpmc(benchmark::State& state)
+{
+    if (state.thread_index() == 0) mpmc_queue = std::make_unique<mpmc_ringbuf>(1024);
+
+    for (auto _ : state)
+    {
+        while (!mpmc_queue->try_push(42)) {}
+        while (!mpmc_queue->pop_front()) {}
+    }
+
+    state.SetItemsProcessed(2 * state.iterations());
+    if (state.thread_index() == 0) mpmc_queue.reset();
+}
+BENCHMARK(lock_free_ringbuf_mpmc)->ThreadRange(1, 16)->UseRealTime();
+
+/*
+    The same, but with one shard per thread: producers don't contend on one index,
+    in exchange for FIFO order only within a shard.
+*/
+template <typename Queue>
+void
+sharded_queue_mpmc(benchmark::State& state, std::unique_ptr<Queue>& queue)
+{
+    if (state.thread_index() == 0) queue = std::make_unique<Queue>(state.threads(), 1024);
+
+    for (auto _ : state)
+    {
+        while (!queue->try_push(42)) {}
+        while (!queue->pop_front()) {}
+    }
+
+    state.SetItemsProcessed(2 * state.iterations());
+    if (state.thread_index() == 0) queue.reset();
+}
+
+using round_robin_queue = tt::sharded_queue<int, std::allocator<int>, tt::steal::round_robin>;
+std::unique_ptr<round_robin_queue> round_robin_sharded_queue;
+
+void
+sharded_queue_mpmc_round_robin(benchmark::State& state)
+{
+    sharded_queue_mpmc(state, round_robin_sharded_queue);
+}
+BENCHMARK(sharded_queue_mpmc_round_robin)->ThreadRange(1, 16)->UseRealTime();
+
+using two_choices_queue = tt::sharded_queue<int, std::allocator<int>, tt::steal::two_choices>;
+std::unique_ptr<two_choices_queue> two_choices_sharded_queue;
+
+void
+sharded_queue_mpmc_two_choices(benchmark::State& state)
+{
+    sharded_queue_mpmc(state, two_choices_sharded_queue);
+}
+BENCHMARK(sharded_queue_mpmc_two_choices)->ThreadRange(1, 16)->UseRealTime();
+
+// same as above, but each thread pushes and pops batches of `state.range(0)` elements
+void
+lock_free_ringbuf_mpmc_batch(benchmark::State& state)
+{
+    if (state.thread_index() == 0) mpmc_queue = std::make_unique<mpmc_ringbuf>(1024);
+
+    std::vector<int> batch(state.range(0), 42);
+    for (auto _ : state)
+    {
+        for (std::span<int const> rest{ batch }; !rest.empty();)
+            rest = rest.subspan(mpmc_queue->try_push_n(rest));
+        for (std::span<int> rest{ batch }; !rest.empty();)
+            rest = rest.subspan(mpmc_queue->try_pop_n(rest));
+    }
+
+    state.SetItemsProcessed(2 * state.iterations() * state.range(0));
+    if (state.thread_index() == 0) mpmc_queue.reset();
+}
+BENCHMARK(lock_free_ringbuf_mpmc_batch)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->RangeMultiplier(4)
+    ->Range(4, 64);
+
+/*
+    Bursty MPMC: each thread pushes a burst of `state.range(0)` elements, then pops as many.
+    Bursts of all threads together can exceed capacity of bounded queue, so it rejects part
+    of them (counted in `dropped`), while unbounded queue takes everything.
+*/
+template <typename Queue>
+void
+mpmc_burst(benchmark::State& state, std::unique_ptr<Queue>& queue, auto&&... ctor_args)
+{
+    if (state.thread_index() == 0) queue = std::make_unique<Queue>(ctor_args...);
+
+    auto const burst{ static_cast<std::size_t>(state.range(0)) };
+    std::size_t processed{ 0 };
+    std::size_t dropped{ 0 };
+    for (auto _ : state)
+    {
+        for (std::size_t i{ 0 }; i < burst; ++i)
+        {
+            if constexpr (requires { queue->try_push(42); })
+            {
+                if (!queue->try_push(42)) ++dropped;
+            } else
+            {
+                queue->push_back(42);
+            }
+        }
+        for (std::size_t i{ 0 }; i < burst && queue->pop_front(); ++i) ++processed;
+    }
+
+    state.SetItemsProcessed(processed);
+    state.counters["dropped"] = benchmark::Counter(dropped, benchmark::Counter::kAvgIterations);
+    if (state.thread_index() == 0) queue.reset();
+}
+
+std::unique_ptr<tt::unbounded_queue<int>> unbounded_queue;
+
+void
+lock_free_ringbuf_mpmc_burst(benchmark::State& state)
+{
+    mpmc_burst(state, mpmc_queue, 1024);
+}
+BENCHMARK(lock_free_ringbuf_mpmc_burst)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->RangeMultiplier(8)
+    ->Range(64, 4096);
+
+void
+unbounded_queue_mpmc_burst(benchmark::State& state)
+{
+    mpmc_burst(state, unbounded_queue);
+}
+BENCHMARK(unbounded_queue_mpmc_burst)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->RangeMultiplier(8)
+    ->Range(64, 4096);
+
+/*
+    SPSC: thread 0 produces, thread 1 consumes.
+    Each thread runs the same number of iterations, so every pushed element is popped.
+*/
+template <typename Queue, typename... Args>
+void
+spsc(benchmark::State& state, std::unique_ptr<Queue>& queue, Args... ctor_args)
+{
+    if (state.thread_index() == 0) queue = std::make_unique<Queue>(ctor_args...);
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+            while (!queue->try_push(42)) {}
+        else
+            while (!queue->pop_front()) {}
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+std::unique_ptr<mpmc_ringbuf> spsc_lock_free_queue;
+
+void
+lock_free_ringbuf_spsc(benchmark::State& state)
+{
+    spsc(state, spsc_lock_free_queue, 1024);
+}
+BENCHMARK(lock_free_ringbuf_spsc)->Threads(2)->UseRealTime();
+
+std::unique_ptr<tt::spsc_ringbuf<int>> spsc_queue;
+
+void
+spsc_ringbuf_spsc(benchmark::State& state)
+{
+    spsc(state, spsc_queue, 1024);
+}
+BENCHMARK(spsc_ringbuf_spsc)->Threads(2)->UseRealTime();
+
+// each iteration moves a batch of `state.range(0)` elements
+void
+spsc_ringbuf_spsc_bulk(benchmark::State& state)
+{
+    if (state.thread_index() == 0) spsc_queue = std::make_unique<tt::spsc_ringbuf<int>>(1024);
+
+    std::vector<int> batch(state.range(0), 42);
+    for (auto _ : state)
+    {
+        std::span<int> rest{ batch };
+        while (!rest.empty())
+        {
+            auto const n{ state.thread_index() == 0 ? spsc_queue->push_n(rest)
+                                                    : spsc_queue->pop_n(rest) };
+            rest = rest.subspan(n);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(spsc_ringbuf_spsc_bulk)->Threads(2)->UseRealTime()->RangeMultiplier(4)->Range(4, 256);
+
+/*
+    Fan-out: thread 0 writes a stream, which is read by all other threads.
+    `multicast_ringbuf` keeps one copy of stream, while without it the stream is copied
+    to own `spsc_ringbuf` of each reader.
+*/
+constexpr int fanout_readers{ 3 };
+
+struct multicast_fanout
+{
+    tt::multicast_ringbuf<int> ring{ 1024 };
+    std::vector<tt::multicast_ringbuf<int>::reader*> readers;
+};
+std::unique_ptr<multicast_fanout> multicast;
+
+void
+multicast_ringbuf_fanout(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        multicast = std::make_unique<multicast_fanout>();
+        for (int i{ 0 }; i < fanout_readers; ++i)
+            multicast->readers.push_back(&multicast->ring.add_reader());
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+            multicast->ring.push(42);
+        else
+            multicast->readers[state.thread_index() - 1]->poll_wait(
+                [](int v) { benchmark::DoNotOptimize(v); }, 1);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(multicast_ringbuf_fanout)->Threads(1 + fanout_readers)->UseRealTime();
+
+std::vector<std::unique_ptr<tt::spsc_ringbuf<int>>> fanout_queues;
+
+void
+spsc_ringbuf_fanout(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        fanout_queues.clear();
+        for (int i{ 0 }; i < fanout_readers; ++i)
+            fanout_queues.push_back(std::make_unique<tt::spsc_ringbuf<int>>(1024));
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            for (auto& q : fanout_queues)
+                while (!q->try_push(42)) {}
+        } else
+        {
+            while (!fanout_queues[state.thread_index() - 1]->pop_front()) {}
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(spsc_ringbuf_fanout)->Threads(1 + fanout_readers)->UseRealTime();
+
+/*
+    Producers x consumers matrix: each iteration moves `matrix_items` elements
+    from `producers` threads to `consumers` threads through one bounded queue.
+    Threads are started once per run, pinned to different cores (if there are enough of them)
+    and synchronized with barriers around each iteration.
+
+    Every `latency_sample_period`-th element carries time of its push, consumer puts time from
+    push to pop into histogram, which is reported as `p50`, `p99` and `p99.9` in nanoseconds.
+    Elements are stamped not all, so clock doesn't dominate throughput.
+*/
+constexpr std::size_t matrix_items{ 1 << 16 };
+constexpr std::size_t matrix_capacity{ 1024 };
+constexpr std::size_t latency_sample_period{ 16 };
+
+struct timed_message
+{
+    // nanoseconds of steady clock, zero if not sampled
+    std::int64_t stamp;
+    std::uint64_t payload;
+};
+
+std::int64_t
+now_ns() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/*
+    Log-linear histogram: 16 buckets per power of 2, so value is rounded down
+    by no more than 1/16, whatever its magnitude is.
+*/
+class latency_histogram
+{
+public:
+    void
+    record(std::uint64_t ns) noexcept
+    {
+        ++m_counts[index(ns)];
+        ++m_total;
+    }
+
+    void
+    merge(latency_histogram const& other) noexcept
+    {
+        for (std::size_t i{ 0 }; i < m_counts.size(); ++i) m_counts[i] += other.m_counts[i];
+        m_total += other.m_total;
+    }
+
+    ///! @param q is in [0, 1]
+    std::uint64_t
+    percentile(double q) const noexcept
+    {
+        auto const target{ static_cast<std::uint64_t>(q * static_cast<double>(m_total)) };
+        std::uint64_t seen{ 0 };
+        for (std::size_t i{ 0 }; i < m_counts.size(); ++i)
+        {
+            seen += m_counts[i];
+            if (seen > target) return lower_bound(i);
+        }
+        return 0;
+    }
+
+    void
+    report(benchmark::State& state) const
+    {
+        state.counters["p50"] = static_cast<double>(percentile(0.5));
+        state.counters["p99"] = static_cast<double>(percentile(0.99));
+        state.counters["p99.9"] = static_cast<double>(percentile(0.999));
+    }
+
+private:
+    static constexpr int sub_bits{ 4 };
+    static constexpr std::uint64_t sub_mask{ (1 << sub_bits) - 1 };
+
+    static std::size_t
+    index(std::uint64_t v) noexcept
+    {
+        if (v <= sub_mask) return v;
+        int const shift{ static_cast<int>(std::bit_width(v)) - 1 - sub_bits };
+        return (static_cast<std::size_t>(shift + 1) << sub_bits) | ((v >> shift) & sub_mask);
+    }
+
+    static std::uint64_t
+    lower_bound(std::size_t i) noexcept
+    {
+        std::size_t const bucket{ i >> sub_bits };
+        std::uint64_t const sub{ i & sub_mask };
+        return bucket == 0 ? sub : ((sub_mask + 1) | sub) << (bucket - 1);
+    }
+
+    std::array<std::uint64_t, 64 << sub_bits> m_counts{};
+    std::uint64_t m_total{ 0 };
+};
+
+///! @return false, if thread can't be pinned, e.g. because of cgroup restrictions
+bool
+pin_to_core(std::size_t core) noexcept
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+    return 0 == ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+}
+
+// the simplest thread-safe queue, bounded like the others for fairness
+class mutex_deque
+{
+public:
+    explicit mutex_deque(std::size_t capacity)
+        : m_capacity{ capacity }
+    {
+    }
+
+    bool
+    try_push(timed_message const& m)
+    {
+        std::lock_guard const lock{ m_mutex };
+        if (m_queue.size() == m_capacity) return false;
+        m_queue.push_back(m);
+        return true;
+    }
+
+    std::optional<timed_message>
+    pop_front()
+    {
+        std::lock_guard const lock{ m_mutex };
+        if (m_queue.empty()) return std::nullopt;
+        timed_message const m{ m_queue.front() };
+        m_queue.pop_front();
+        return m;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::deque<timed_message> m_queue;
+    std::size_t m_capacity;
+};
+
+template <typename Queue>
+void
+matrix(benchmark::State& state)
+{
+    auto const producers{ static_cast<std::size_t>(state.range(0)) };
+    auto const consumers{ static_cast<std::size_t>(state.range(1)) };
+
+    Queue queue{ matrix_capacity };
+    std::barrier start{ static_cast<std::ptrdiff_t>(producers + consumers + 1) };
+    std::barrier done{ static_cast<std::ptrdiff_t>(producers + consumers + 1) };
+    std::atomic<bool> stop{ false };
+    std::atomic<std::size_t> pinned{ 0 };
+    std::vector<latency_histogram> histograms(consumers);
+
+    // returns false, when benchmark is over
+    auto const wait_start = [&]
+    {
+        start.arrive_and_wait();
+        return !stop.load(std::memory_order::relaxed);
+    };
+
+    std::vector<std::jthread> threads;
+    for (std::size_t p{ 0 }; p < producers; ++p)
+        threads.emplace_back(
+            [&, p]
+            {
+                if (pin_to_core(p)) pinned.fetch_add(1, std::memory_order::relaxed);
+                while (wait_start())
+                {
+                    for (std::size_t i{ 0 }; i < matrix_items / producers; ++i)
+                    {
+                        timed_message const m{
+                            .stamp = i % latency_sample_period == 0 ? now_ns() : 0,
+                            .payload = i,
+                        };
+                        tt::wait::backoff<tt::wait::spin_yield> backoff;
+                        while (!queue.try_push(m)) (void)backoff();
+                    }
+                    done.arrive_and_wait();
+                }
+            });
+
+    for (std::size_t c{ 0 }; c < consumers; ++c)
+        threads.emplace_back(
+            [&, c]
+            {
+                if (pin_to_core(producers + c)) pinned.fetch_add(1, std::memory_order::relaxed);
+                while (wait_start())
+                {
+                    for (std::size_t i{ 0 }; i < matrix_items / consumers; ++i)
+                    {
+                        tt::wait::backoff<tt::wait::spin_yield> backoff;
+                        std::optional<timed_message> m;
+                        while (!(m = queue.pop_front())) (void)backoff();
+                        if (m->stamp != 0) histograms[c].record(now_ns() - m->stamp);
+                    }
+                    done.arrive_and_wait();
+                }
+            });
+
+    for (auto _ : state)
+    {
+        start.arrive_and_wait();
+        done.arrive_and_wait();
+    }
+
+    stop.store(true, std::memory_order::relaxed);
+    start.arrive_and_wait();
+    threads.clear();
+
+    latency_histogram total;
+    for (auto const& h : histograms) total.merge(h);
+    total.report(state);
+    state.counters["pinned"] = static_cast<double>(pinned.load() == producers + consumers);
+    state.SetItemsProcessed(state.iterations() * matrix_items);
+}
+
+void
+lock_free_ringbuf_matrix(benchmark::State& state)
+{
+    matrix<tt::lock_free_ringbuf<timed_message, std::allocator<timed_message>,
+                                 tt::overflow::reject_newest>>(state);
+}
+BENCHMARK(lock_free_ringbuf_matrix)
+    ->ArgsProduct({ { 1, 2, 4, 8 }, { 1, 2, 4, 8 } })
+    ->ArgNames({ "producers", "consumers" })
+    ->UseRealTime();
+
+void
+mutex_deque_matrix(benchmark::State& state)
+{
+    matrix<mutex_deque>(state);
+}
+BENCHMARK(mutex_deque_matrix)
+    ->ArgsProduct({ { 1, 2, 4, 8 }, { 1, 2, 4, 8 } })
+    ->ArgNames({ "producers", "consumers" })
+    ->UseRealTime();
+
+// the same elements and stamps, but one thread and no synchronization at all
+void
+ringbuf_single_thread(benchmark::State& state)
+{
+    tt::ringbuf<timed_message, std::allocator<timed_message>, tt::overflow::reject_newest> queue{
+        matrix_capacity
+    };
+    latency_histogram histogram;
+
+    for (auto _ : state)
+    {
+        for (std::size_t i{ 0 }; i < matrix_items; ++i)
+        {
+            (void)queue.try_push({ .stamp = i % latency_sample_period == 0 ? now_ns() : 0,
+                                   .payload = i });
+            timed_message const m{ *queue.pop_front() };
+            if (m.stamp != 0) histogram.record(now_ns() - m.stamp);
+        }
+    }
+
+    histogram.report(state);
+    state.SetItemsProcessed(state.iterations() * matrix_items);
+}
+BENCHMARK(ringbuf_single_thread)->UseRealTime();
+
+/*
+    Latest value: thread 0 publishes snapshots, thread 1 needs only the newest one.
+    Through ringbuf reader drains and drops everything stale and each snapshot is copied
+    in and out, through `triple_buffer` both sides do one exchange and no copies.
+    `fresh` is share of reads, which got a snapshot newer than the previous one.
+*/
+struct snapshot
+{
+    std::uint64_t seq;
+    std::byte payload[248];
+};
+
+void
+latest(benchmark::State& state, auto&& publish, auto&& read)
+{
+    std::uint64_t seq{ 0 };
+    std::uint64_t last{ 0 };
+    std::uint64_t fresh{ 0 };
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            publish(++seq);
+        } else
+        {
+            std::uint64_t const s{ read() };
+            if (s != last) ++fresh;
+            last = s;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 1)
+        state.counters["fresh"] = static_cast<double>(fresh) / state.iterations();
+}
+
+std::unique_ptr<tt::triple_buffer<snapshot>> mailbox;
+
+void
+triple_buffer_latest(benchmark::State& state)
+{
+    if (state.thread_index() == 0) mailbox = std::make_unique<tt::triple_buffer<snapshot>>();
+
+    latest(
+        state,
+        [](std::uint64_t seq)
+        {
+            mailbox->back().seq = seq;
+            mailbox->publish();
+        },
+        [] { return mailbox->read().seq; });
+}
+BENCHMARK(triple_buffer_latest)->Threads(2)->UseRealTime();
+
+std::unique_ptr<tt::lock_free_ringbuf<snapshot>> snapshots;
+
+void
+lock_free_ringbuf_latest(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+        snapshots = std::make_unique<tt::lock_free_ringbuf<snapshot>>(64);
+
+    std::uint64_t last{ 0 };
+    latest(
+        state,
+        [](std::uint64_t seq)
+        {
+            snapshot s;
+            s.seq = seq;
+            snapshots->push_back(s);
+        },
+        [&]
+        {
+            // drain, keep only the newest
+            while (std::optional<snapshot> s{ snapshots->pop_front() }) last = s->seq;
+            return last;
+        });
+}
+BENCHMARK(lock_free_ringbuf_latest)->Threads(2)->UseRealTime();
+
+/*
+    IPC: child process sends messages, parent receives them.
+    Through `shm_ringbuf` it's one copy each side and no syscalls,
+    through pipe it's `write` and `read`, each copies message to/from kernel.
+*/
+struct ipc_message
+{
+    std::uint64_t seq;
+    std::byte payload[56];
+};
+
+void
+ipc(benchmark::State& state, auto&& send, auto&& receive)
+{
+    auto const count{ state.max_iterations };
+    pid_t const child{ ::fork() };
+    if (0 == child)
+    {
+        ipc_message msg{};
+        for (benchmark::IterationCount i{ 0 }; i < count; ++i)
+        {
+            msg.seq = i;
+            send(msg);
+        }
+        ::_exit(0);
+    }
+
+    for (auto _ : state) benchmark::DoNotOptimize(receive());
+
+    ::waitpid(child, nullptr, 0);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(ipc_message));
+}
+
+void
+shm_ringbuf_ipc(benchmark::State& state)
+{
+    auto buf{ tt::shm_ringbuf<ipc_message>::anonymous(1024) };
+    ipc(state, [&](ipc_message const& msg) { buf.push_wait(msg); },
+        [&] { return buf.pop_wait(); });
+}
+BENCHMARK(shm_ringbuf_ipc)->UseRealTime();
+
+void
+pipe_ipc(benchmark::State& state)
+{
+    int fds[2];
+    if (0 != ::pipe(fds))
+    {
+        state.SkipWithError("pipe failed");
+        return;
+    }
+
+    ipc(
+        state,
+        [&](ipc_message const& msg)
+        {
+            // message is smaller than PIPE_BUF, so write is atomic
+            (void)::write(fds[1], &msg, sizeof(msg));
+        },
+        [&]
+        {
+            ipc_message msg;
+            (void)::read(fds[0], &msg, sizeof(msg));
+            return msg;
+        });
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+BENCHMARK(pipe_ipc)->UseRealTime();
+
+BENCHMARK_MAIN();
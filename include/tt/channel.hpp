@@ -0,0 +1,378 @@
+#pragma once
+
+#include <tt/detail.hpp>
+#include <tt/lock_free_ringbuf.hpp>
+#include <tt/overflow.hpp>
+#include <tt/unbounded_queue.hpp>
+
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace tt
+{
+
+///! something, what can run callable later or in other thread, e.g. `thread_pool`
+template <typename E>
+concept executor = requires(E& e, void (*fn)()) { e.submit(fn); };
+
+///! runs callable right in the calling thread
+struct inline_executor
+{
+    void
+    submit(std::invocable auto&& fn)
+    {
+        std::invoke(fn);
+    }
+};
+
+/*
+    Bounded MPMC channel for coroutines over `lock_free_ringbuf`.
+
+    ```
+        int v{ co_await ch.pop() };  // suspends, while channel is empty
+        co_await ch.push(v);         // suspends, while channel is full
+    ```
+
+    Suspended coroutines are kept in lock-free waiter lists (`unbounded_queue` of awaiters,
+    which live in coroutine frames, so suspension doesn't allocate in steady state).
+    Push hands element to exactly one waiting consumer and pop takes value of exactly one
+    waiting producer, then the waiter is resumed on `executor_type`.
+
+    When nobody waits, `try_push` and `try_pop` are the same as for `lock_free_ringbuf`
+    plus one load of counter of waiters on the opposite side.
+
+    Waiter and the opposite side use Dekker-like handshake, the same as parking in
+    `lock_free_ringbuf`: waiter publishes itself and then checks buffer again, while
+    push (pop) changes buffer index and then checks waiters. All of them are seq_cst,
+    so at least one side sees the other and wakeup is not lost.
+
+    Channel must outlive all its waiters.
+*/
+template <std::movable T, executor Executor = inline_executor, typename Alloc = std::allocator<T>>
+class channel
+{
+public:
+    using this_type = channel<T, Executor, Alloc>;
+    using buffer_type = lock_free_ringbuf<T, Alloc, overflow::reject_newest>;
+
+    using allocator_type = Alloc;
+    using executor_type = Executor;
+    using value_type = buffer_type::value_type;
+    using size_type = buffer_type::size_type;
+
+    class pop_awaiter
+    {
+    public:
+        explicit pop_awaiter(this_type& ch)
+            : m_channel{ ch }
+        {
+        }
+
+        pop_awaiter(pop_awaiter const&) = delete;
+        pop_awaiter& operator=(pop_awaiter const&) = delete;
+
+        bool
+        await_ready()
+        {
+            m_value = m_channel.try_pop();
+            return m_value.has_value();
+        }
+
+        bool
+        await_suspend(std::coroutine_handle<> h)
+        {
+            m_handle = h;
+            // since now awaiter can be resumed and destroyed by other thread at any moment
+            return m_channel.park_consumer(this);
+        }
+
+        value_type
+        await_resume()
+        {
+            return std::move(*m_value);
+        }
+
+    private:
+        friend this_type;
+
+        this_type& m_channel;
+        std::optional<value_type> m_value;
+        std::coroutine_handle<> m_handle;
+    };
+
+    class push_awaiter
+    {
+    public:
+        push_awaiter(this_type& ch, value_type&& v)
+            : m_channel{ ch }
+            , m_value{ std::move(v) }
+        {
+        }
+
+        push_awaiter(push_awaiter const&) = delete;
+        push_awaiter& operator=(push_awaiter const&) = delete;
+
+        bool
+        await_ready()
+        {
+            // rejected push doesn't touch value, so it's still here for `await_suspend`
+            return m_channel.try_push(std::move(m_value));
+        }
+
+        bool
+        await_suspend(std::coroutine_handle<> h)
+        {
+            m_handle = h;
+            // since now awaiter can be resumed and destroyed by other thread at any moment
+            return m_channel.park_producer(this);
+        }
+
+        void
+        await_resume() const noexcept
+        {
+        }
+
+    private:
+        friend this_type;
+
+        this_type& m_channel;
+        value_type m_value;
+        std::coroutine_handle<> m_handle;
+    };
+
+private:
+    // waiters are rare, so small segments are enough
+    static constexpr std::size_t waiters_segment_capacity{ 32 };
+
+    template <typename Awaiter>
+    using waiters_allocator =
+        std::allocator_traits<allocator_type>::template rebind_alloc<Awaiter*>;
+
+    template <typename Awaiter>
+    using waiters_type =
+        unbounded_queue<Awaiter*, waiters_allocator<Awaiter>, waiters_segment_capacity>;
+
+public:
+    ///! @pre `capacity` is power of 2
+    channel(size_type capacity, executor_type& executor,
+            allocator_type const& alloc = allocator_type())
+        : m_buffer{ capacity, alloc }
+        , m_consumers{ 8, waiters_allocator<pop_awaiter>(alloc) }
+        , m_producers{ 8, waiters_allocator<push_awaiter>(alloc) }
+        , m_executor{ &executor }
+    {
+    }
+
+    ///! waiters are resumed right in thread, which pushed or popped
+    ///! @pre `capacity` is power of 2
+    explicit channel(size_type capacity, allocator_type const& alloc = allocator_type())
+        requires std::same_as<executor_type, inline_executor>
+        : channel(capacity, default_executor(), alloc)
+    {
+    }
+
+    channel(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    ///! approximate, if other threads push or pop concurrently
+    size_type
+    size() const noexcept
+    {
+        return m_buffer.size();
+    }
+
+    size_type
+    capacity() const noexcept
+    {
+        return m_buffer.capacity();
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return m_buffer.empty();
+    }
+
+    ///! suspends until element is got
+    [[nodiscard]] pop_awaiter
+    pop()
+    {
+        return pop_awaiter{ *this };
+    }
+
+    ///! suspends until `v` is pushed
+    [[nodiscard]] push_awaiter
+    push(value_type v)
+    {
+        return push_awaiter{ *this, std::move(v) };
+    }
+
+    bool
+    try_push(value_type const& v)
+    {
+        return try_emplace_back(v);
+    }
+
+    bool
+    try_push(value_type&& v)
+    {
+        return try_emplace_back(std::forward<value_type>(v));
+    }
+
+    ///! if there are waiting consumers, one of them gets the element and is resumed
+    ///! @return false if channel is full
+    bool
+    try_emplace_back(auto&&... args)
+        requires std::is_constructible_v<value_type, decltype(args)...>
+    {
+        if (!m_buffer.try_emplace_back(std::forward<decltype(args)>(args)...)) return false;
+
+        // the only extra cost, when nobody waits
+        if (0 != m_parked_consumers.load(std::memory_order::seq_cst)) (void)wake_consumer();
+        return true;
+    }
+
+    ///! if there are waiting producers, one of them pushes its value and is resumed
+    std::optional<value_type>
+    try_pop()
+    {
+        std::optional<value_type> v{ m_buffer.pop_front() };
+
+        // the only extra cost, when nobody waits
+        if (v && 0 != m_parked_producers.load(std::memory_order::seq_cst)) (void)wake_producer();
+        return v;
+    }
+
+private:
+    static inline_executor&
+    default_executor() noexcept
+    {
+        static inline_executor e;
+        return e;
+    }
+
+    // @return false, if `self` got element already and must not suspend
+    bool
+    park_consumer(pop_awaiter* self)
+    {
+        register_consumer(self);
+        // element could be pushed before we registered, and pusher didn't see us.
+        // Waiter is taken from the head of list only, if needed, so waiters are resumed FIFO
+        return m_buffer.empty() || !wake_consumer(self);
+    }
+
+    // @return false, if value of `self` is pushed already and it must not suspend
+    bool
+    park_producer(push_awaiter* self)
+    {
+        register_producer(self);
+        // slot could be freed before we registered, and popper didn't see us
+        return m_buffer.full() || !wake_producer(self);
+    }
+
+    void
+    register_consumer(pop_awaiter* w)
+    {
+        m_consumers.push_back(w);
+        m_parked_consumers.fetch_add(1, std::memory_order::seq_cst);
+        // pairs with seq_cst CAS of index in `m_buffer` and load of counter in `try_push`:
+        // either pusher sees us, or we see its element in the following check of buffer
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+    }
+
+    void
+    register_producer(push_awaiter* w)
+    {
+        m_producers.push_back(w);
+        m_parked_producers.fetch_add(1, std::memory_order::seq_cst);
+        // see `register_consumer`
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+    }
+
+    // gives one element to one waiting consumer, if there are both.
+    // @return true, if it was `self`, which is not suspended yet, so it's not resumed
+    bool
+    wake_consumer(pop_awaiter const* self = nullptr)
+    {
+        while (0 != m_parked_consumers.load(std::memory_order::seq_cst))
+        {
+            // if counter is not zero, but list is empty, then other thread has just taken
+            // the waiter and will take care of it
+            std::optional<pop_awaiter*> const w{ m_consumers.pop_front() };
+            if (!w) return false;
+            m_parked_consumers.fetch_sub(1, std::memory_order::relaxed);
+
+            pop_awaiter* const consumer{ *w };
+            consumer->m_value = m_buffer.pop_front();
+            if (!consumer->m_value)
+            {
+                // element is taken by consumer, which didn't wait, so put waiter back.
+                // Element pushed meanwhile is found by this check, see `register_consumer`
+                register_consumer(consumer);
+                if (m_buffer.empty()) return false;
+                continue;
+            }
+
+            // slot is freed
+            if (0 != m_parked_producers.load(std::memory_order::seq_cst)) (void)wake_producer();
+
+            if (consumer == self) return true;
+            resume(consumer->m_handle);
+            return false;
+        }
+        return false;
+    }
+
+    // pushes value of one waiting producer, if there are waiter and free slot.
+    // @return true, if it was `self`, which is not suspended yet, so it's not resumed
+    bool
+    wake_producer(push_awaiter const* self = nullptr)
+    {
+        while (0 != m_parked_producers.load(std::memory_order::seq_cst))
+        {
+            std::optional<push_awaiter*> const w{ m_producers.pop_front() };
+            if (!w) return false;
+            m_parked_producers.fetch_sub(1, std::memory_order::relaxed);
+
+            push_awaiter* const producer{ *w };
+            if (!m_buffer.try_emplace_back(std::move(producer->m_value)))
+            {
+                register_producer(producer);
+                if (m_buffer.full()) return false;
+                continue;
+            }
+
+            // element is pushed
+            if (0 != m_parked_consumers.load(std::memory_order::seq_cst)) (void)wake_consumer();
+
+            if (producer == self) return true;
+            resume(producer->m_handle);
+            return false;
+        }
+        return false;
+    }
+
+    void
+    resume(std::coroutine_handle<> h)
+    {
+        m_executor->submit([h] { h.resume(); });
+    }
+
+    buffer_type m_buffer;
+
+    waiters_type<pop_awaiter> m_consumers;
+    waiters_type<push_awaiter> m_producers;
+
+    // counters are separate from lists, so check for waiters is one load
+    alignas(detail::cache_line_size) std::atomic<std::uint32_t> m_parked_consumers{ 0 };
+    alignas(detail::cache_line_size) std::atomic<std::uint32_t> m_parked_producers{ 0 };
+
+    executor_type* m_executor;
+};
+
+} // namespace tt
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
 #include <format>
 #include <iostream>
+#include <new>
 #include <source_location>
 #include <type_traits>
 
@@ -31,6 +34,21 @@ struct std::formatter<std::source_location>
 namespace tt::detail
 {
 
+// Data touched by different threads is aligned to this, so threads don't false share cache lines.
+// gcc warns about use of std constant in headers, because it can differ between `-mtune` flags
+#ifdef __cpp_lib_hardware_interference_size
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+inline constexpr std::size_t cache_line_size{ std::hardware_destructive_interference_size };
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+inline constexpr std::size_t cache_line_size{ 64 };
+#endif
+
 // with thanks stolen from https://github.com/hsutter/cppfront/
 template <typename T>
 constexpr bool prefer_pass_by_value =
@@ -73,6 +91,27 @@ divceil(std::size_t const l, std::size_t const r)
     return 1 + ((l - 1) / r);
 }
 
+///! small dense number of the calling thread, given in order of the first call
+inline std::size_t
+thread_index() noexcept
+{
+    static std::atomic<std::size_t> next{ 0 };
+    thread_local std::size_t const index{ next.fetch_add(1, std::memory_order::relaxed) };
+    return index;
+}
+
+///! cheap per-thread pseudo random numbers (xorshift64), good enough to pick a victim
+inline std::uint64_t
+thread_random() noexcept
+{
+    // seed must not be zero
+    thread_local std::uint64_t state{ 0x9e3779b97f4a7c15 * (thread_index() + 1) };
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
 template <typename F1, typename F2, typename... Args>
 concept composable =
     std::invocable<F2, Args...> && std::invocable<F1, std::invoke_result_t<F2, Args...>>;
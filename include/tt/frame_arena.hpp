@@ -0,0 +1,194 @@
+#pragma once
+
+#include <tt/detail.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <system_error>
+
+#include <sys/mman.h>
+
+namespace tt
+{
+
+/*
+    Bump allocator, which is reset once per frame.
+
+    All per-frame allocations (sort buffers, queues of `tt::pmr` containers, etc.)
+    are taken from one region, deallocation does nothing and `reset` frees everything
+    at once in O(1) at the end of frame.
+
+    ```
+        tt::frame_arena arena{ 64 << 20 };
+        while (running)
+        {
+            {
+                tt::pmr::ringbuf<event> events{ 1024, &arena };
+                ...
+            }
+            arena.reset(); // nothing allocated from arena can be used after this
+        }
+    ```
+
+    Region is mapped once and backed by huge pages, if possible: explicit ones
+    (`MAP_HUGETLB`), if they are reserved in system, otherwise transparent huge pages
+    are requested with `madvise`. So frame touches few TLB entries and after the first
+    frame doesn't fault at all.
+
+    If frame needs more than `capacity()`, the rest is taken from `upstream` and
+    is freed by the next `reset` too. It's slower, so look at `peak()` to choose capacity.
+
+    Not thread-safe. Containers, which allocate only on construction (e.g.
+    `pmr::lock_free_ringbuf`), can be shared between threads, but they must be
+    constructed by the thread owning arena.
+*/
+class frame_arena : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t huge_page_size{ 2 << 20 };
+
+    ///! @param capacity is rounded up to `huge_page_size`
+    ///! @throws std::system_error if region can't be mapped
+    explicit frame_arena(std::size_t capacity,
+                         std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : m_capacity{ detail::divceil(std::max<std::size_t>(capacity, 1), huge_page_size) *
+                      huge_page_size }
+        , m_overflow{ upstream }
+    {
+        map();
+    }
+
+    frame_arena(frame_arena const&) = delete;
+    frame_arena& operator=(frame_arena const&) = delete;
+
+    ~frame_arena() override
+    {
+        ::munmap(m_region, m_capacity);
+    }
+
+    ///! frees everything allocated since the previous reset.
+    ///! O(1), unless frame overflowed to upstream
+    void
+    reset() noexcept
+    {
+        m_peak = std::max(m_peak, m_used + m_overflowed);
+        m_used = 0;
+        if (0 != m_overflowed) m_overflow.release();
+        m_overflowed = 0;
+    }
+
+    ///! size of region
+    std::size_t
+    capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    ///! bytes taken from region since the previous reset, including padding
+    std::size_t
+    used() const noexcept
+    {
+        return m_used;
+    }
+
+    ///! bytes taken from upstream since the previous reset
+    std::size_t
+    overflowed() const noexcept
+    {
+        return m_overflowed;
+    }
+
+    ///! max of `used() + overflowed()` over finished frames
+    std::size_t
+    peak() const noexcept
+    {
+        return m_peak;
+    }
+
+    ///! true, if region is backed by explicit huge pages.
+    ///! Otherwise transparent huge pages are only requested and kernel may ignore it
+    bool
+    huge_pages() const noexcept
+    {
+        return m_huge_pages;
+    }
+
+    std::pmr::memory_resource*
+    upstream() const noexcept
+    {
+        return m_overflow.upstream_resource();
+    }
+
+private:
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        // `alignment` is power of 2, and region is aligned to huge page
+        std::size_t const first{ (m_used + alignment - 1) & ~(alignment - 1) };
+        if (first <= m_capacity && bytes <= m_capacity - first)
+        {
+            m_used = first + bytes;
+            return static_cast<std::byte*>(m_region) + first;
+        }
+
+        void* const p{ m_overflow.allocate(bytes, alignment) };
+        m_overflowed += bytes;
+        return p;
+    }
+
+    void
+    do_deallocate(void*, std::size_t, std::size_t) override
+    {
+    }
+
+    bool
+    do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    void
+    map()
+    {
+        int constexpr prot{ PROT_READ | PROT_WRITE };
+        int constexpr flags{ MAP_PRIVATE | MAP_ANONYMOUS };
+
+        m_region = ::mmap(nullptr, m_capacity, prot, flags | MAP_HUGETLB, -1, 0);
+        m_huge_pages = MAP_FAILED != m_region;
+        if (m_huge_pages) return;
+
+        // no reserved huge pages, fall back to regular ones. Transparent huge page is used
+        // only for aligned 2MB range, so map a bit more and trim it
+        std::size_t const mapped{ m_capacity + huge_page_size };
+        void* const p{ ::mmap(nullptr, mapped, prot, flags, -1, 0) };
+        if (MAP_FAILED == p)
+        {
+            m_region = nullptr;
+            throw std::system_error(errno, std::generic_category(), "frame_arena: mmap");
+        }
+
+        auto const begin{ reinterpret_cast<std::uintptr_t>(p) };
+        auto const aligned{ (begin + huge_page_size - 1) & ~(huge_page_size - 1) };
+        if (aligned != begin) ::munmap(p, aligned - begin);
+        ::munmap(reinterpret_cast<void*>(aligned + m_capacity), huge_page_size - (aligned - begin));
+        m_region = reinterpret_cast<void*>(aligned);
+
+        // only a hint, so failure is not an error
+        (void)::madvise(m_region, m_capacity, MADV_HUGEPAGE);
+    }
+
+    void* m_region{ nullptr };
+    std::size_t m_capacity{ 0 };
+    std::size_t m_used{ 0 };
+    bool m_huge_pages{ false };
+
+    // frees everything taken from upstream at once on `reset`
+    std::pmr::monotonic_buffer_resource m_overflow;
+    std::size_t m_overflowed{ 0 };
+    std::size_t m_peak{ 0 };
+};
+
+} // namespace tt
@@ -1,52 +1,137 @@
 #pragma once
 
 #include <tt/detail.hpp>
+#include <tt/overflow.hpp>
+#include <tt/stats.hpp>
+#include <tt/wait.hpp>
 
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <optional>
 #include <ranges>
+#include <span>
+#include <utility>
 
 namespace tt
 {
 
-template <std::semiregular T, typename Alloc = std::allocator<T>>
+/*
+    Bounded MPMC queue (Vyukov), when full acts according to `overflow::policy`.
+
+    With `stats::counting` policy it counts contention (CAS failures, spins, parks),
+    full and empty events, overwrites, high-water mark and sampled push-to-pop latency,
+    see `get_stats`. By default (`stats::none`) all of it is compiled out.
+*/
+template <std::destructible T, typename Alloc = std::allocator<T>,
+          overflow::policy OverflowPolicy = overflow::overwrite_oldest,
+          stats::policy StatsPolicy = stats::none>
 class lock_free_ringbuf
 {
+    static_assert(!std::same_as<OverflowPolicy, overflow::grow>,
+                  "slots of lock_free_ringbuf can be accessed by other threads, so it can't grow");
+
 public:
-    using this_type = lock_free_ringbuf<T, Alloc>;
+    using this_type = lock_free_ringbuf<T, Alloc, OverflowPolicy, StatsPolicy>;
 
     using allocator_type = Alloc;
+    using overflow_policy = OverflowPolicy;
+    using stats_policy = StatsPolicy;
     using allocator_traits = std::allocator_traits<allocator_type>;
     using value_type = allocator_traits::value_type;
     using pointer = allocator_traits::pointer;
     using size_type = allocator_traits::size_type;
 
 private:
-    struct value_type_impl
+    using stats_recorder = stats::recorder<stats_policy>;
+
+    // each slot in its own cache line, so neighbour producers and consumers don't false share.
+    // Value is constructed in place on push and destroyed on pop, so `T` needs no default ctor
+    struct alignas(detail::cache_line_size) value_type_impl
     {
-        value_type value;
+        alignas(value_type) std::byte storage[sizeof(value_type)];
         std::atomic<std::size_t> seq{ 0 };
+        // when element was pushed, if it's sampled for latency. Empty without stats
+        [[no_unique_address]] stats_recorder::stamp_type stamp{};
+
+        value_type*
+        value() noexcept
+        {
+            return std::launder(reinterpret_cast<value_type*>(storage));
+        }
     };
     using allocator_type_impl = allocator_traits::template rebind_alloc<value_type_impl>;
     using allocator_traits_impl = std::allocator_traits<allocator_type_impl>;
     using pointer_impl = allocator_traits_impl::pointer;
 
-private:
+public:
+    /*
+        Exclusive ownership of one slot, got by `try_reserve_back` or `try_peek_front`.
+        Slots are handed out in order, so the owner must `commit_back`/`release_front`
+        it soon, otherwise consumers (producers) of the next positions will wait for it.
+    */
+    class slot
+    {
+    public:
+        slot() = default;
+
+        explicit
+        operator bool() const noexcept
+        {
+            return m_impl != nullptr;
+        }
+
+        value_type*
+        get() const noexcept
+        {
+            return m_impl->value();
+        }
+
+        value_type&
+        operator*() const noexcept
+        {
+            return *get();
+        }
+
+        value_type*
+        operator->() const noexcept
+        {
+            return get();
+        }
+
+    private:
+        friend this_type;
+
+        slot(pointer_impl impl, size_type pos)
+            : m_impl{ impl }
+            , m_pos{ pos }
+        {
+        }
+
+        pointer_impl m_impl{ nullptr };
+        size_type m_pos{ 0 };
+    };
+
 private:
     void
     init_with_capacity(size_type sz)
     {
         m_buf_begin = allocator_traits_impl::allocate(get_allocator_impl(), sz);
         m_capacity = sz;
-        std::for_each_n(m_buf_begin, capacity(),
-                        [cnt = 0](auto& v) mutable { v.seq.exchange(cnt++); });
+        for (size_type i{ 0 }; i < capacity(); ++i)
+        {
+            allocator_traits_impl::construct(get_allocator_impl(), m_buf_begin + i);
+            m_buf_begin[i].seq.store(empty_seq(i), std::memory_order::relaxed);
+        }
 
-        m_last.store(0, std::memory_order::seq_cst);
-        m_first.store(0, std::memory_order::seq_cst);
+        m_last.store(0, std::memory_order::relaxed);
+        m_first.store(0, std::memory_order::relaxed);
     }
 
 public:
@@ -65,15 +150,25 @@ public:
         assign(std::forward<this_type>(other));
     }
 
+    lock_free_ringbuf(this_type&& other, allocator_type const& alloc)
+        : m_allocator(alloc)
+    {
+        init_with_capacity(other.capacity());
+        assign(std::forward<this_type>(other));
+    }
+
     this_type&
     operator=(this_type other) noexcept
     {
         assign(std::move(other));
+        return *this;
     }
 
     ~lock_free_ringbuf()
     {
         clear();
+        for (size_type i{ 0 }; i < capacity(); ++i)
+            allocator_traits_impl::destroy(get_allocator_impl(), m_buf_begin + i);
         allocator_traits_impl::deallocate(get_allocator_impl(), m_buf_begin, capacity());
     }
 
@@ -81,18 +176,14 @@ public:
     assign(this_type&& other)
     {
         clear();
-        while (!other.empty()) push_back(*other.pop_front());
+        while (auto v{ other.pop_front() }) push_back(std::move(*v));
     }
 
+    // NOTE: indices are not reset, because sequences of slots are already bound to them
     void
     clear() noexcept
     {
-        while (size())
-        {
-            (void)pop_front();
-        }
-        m_first.store(0, std::memory_order::seq_cst);
-        m_last.store(0, std::memory_order::seq_cst);
+        while (discard_front()) {}
     }
 
     allocator_type
@@ -101,10 +192,18 @@ public:
         return allocator_type(get_allocator_impl());
     }
 
+    ///! approximate, if other threads push or pop concurrently.
+    ///! Also counts elements, which are still being pushed
     size_type
     size() const noexcept
     {
-        return m_size.load(std::memory_order::seq_cst);
+        size_type const first{ m_first.load(std::memory_order::relaxed) };
+        size_type const last{ m_last.load(std::memory_order::relaxed) };
+
+        // `first` can be already stale and overtaken by `last` for more than capacity, or vice
+        // versa, consumers can overtake stale `last`
+        std::int64_t const diff{ static_cast<std::int64_t>(last - first) };
+        return std::clamp<std::int64_t>(diff, 0, static_cast<std::int64_t>(capacity()));
     }
 
     size_type
@@ -137,6 +236,21 @@ public:
         return capacity() - size();
     }
 
+    ///! counters summed over all threads, approximate while ringbuf is used
+    stats::snapshot
+    get_stats() const noexcept
+        requires stats::enabled<stats_policy>
+    {
+        return m_stats.get();
+    }
+
+    void
+    reset_stats() noexcept
+        requires stats::enabled<stats_policy>
+    {
+        m_stats.reset();
+    }
+
     void
     push_back(value_type const& v)
     {
@@ -153,61 +267,277 @@ public:
     emplace_back(auto&&... args)
         requires std::is_constructible_v<value_type, decltype(args)...>
     {
-        pointer_impl ptr{ nullptr };
-        size_type pos{ m_last.load(std::memory_order::seq_cst) };
+        (void)try_emplace_back(std::forward<decltype(args)>(args)...);
+    }
 
-        // Here I use the idea of Dmitry Vyukov.
-        // https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue for details
-        // briefly, we enumerate each element by it position in ringbuf ctor and increase this
-        // number, when someone take exclusive ownership on it.
-        // So, we (read - this thread) can know, that is not we and just return false
+    bool
+    try_push(value_type const& v)
+    {
+        return try_emplace_back(v);
+    }
+
+    bool
+    try_push(value_type&& v)
+    {
+        return try_emplace_back(std::forward<value_type>(v));
+    }
+
+    ///! @return false if element was not inserted due to `overflow_policy`
+    bool
+    try_emplace_back(auto&&... args)
+        requires std::is_constructible_v<value_type, decltype(args)...>
+    {
+        return emplace_back_as<overflow_policy>(std::forward<decltype(args)>(args)...);
+    }
+
+    std::optional<value_type>
+    pop_front()
+        requires std::move_constructible<value_type>
+    {
+        slot const s{ try_peek_front() };
+        if (!s) return std::nullopt;
+
+        std::optional<value_type> ret{ std::move(*s) };
+        release_front(s);
+        return ret;
+    }
+
+    /*
+        Two-phase push and pop. Value is constructed and read right in the slot,
+        so there is no temporary, no `std::optional` and `T` can be even immovable.
+
+        ```
+            if (auto s{ buf.try_reserve_back() })
+            {
+                std::construct_at(s.get(), args...);
+                buf.commit_back(s);
+            }
+
+            if (auto s{ buf.try_peek_front() })
+            {
+                read(*s);
+                buf.release_front(s);
+            }
+        ```
+    */
+
+    ///! reserves slot for the next element, when full acts according to `overflow_policy`.
+    ///! NOTE: with `overwrite_oldest` the oldest element is dropped right here, not in
+    ///!       `commit_back`, and reservation can't be cancelled
+    ///! @return empty slot, if element can't be pushed
+    slot
+    try_reserve_back()
+    {
+        return reserve_back_as<overflow_policy>();
+    }
+
+    ///! publishes element to consumers
+    ///! @pre `s` is reserved by `try_reserve_back` and value is constructed in it
+    void
+    commit_back(slot s) noexcept
+    {
+        assert(s);
+        s.m_impl->stamp = m_stats.stamp_push();
+        if constexpr (stats::enabled<stats_policy>)
+            m_stats.update_high_water(s.m_pos + 1 - m_first.load(std::memory_order::relaxed));
+
+        s.m_impl->seq.store(full_seq(s.m_pos), std::memory_order::release);
+        notify_consumers(1);
+    }
+
+    ///! takes the oldest element, it stays in slot until `release_front`
+    ///! @return empty slot, if there is no elements
+    slot
+    try_peek_front() noexcept
+    {
+        slot const s{ take_front() };
+        if (!s) m_stats.add(stats::event::empty);
+        return s;
+    }
+
+    ///! destroys element and gives slot back to producers
+    ///! @pre `s` is taken by `try_peek_front`
+    void
+    release_front(slot s) noexcept
+    {
+        assert(s);
+        m_stats.record_pop(s.m_impl->stamp);
+        release(s);
+    }
+
+    /*
+        Blocking versions wait until there is a free slot (for push) or element (for pop).
+        `push_wait` never overwrites, whatever `overflow_policy` is.
+
+        How exactly to wait is chosen by `wait::strategy`. With `wait::spin_park` thread
+        sleeps in `std::atomic::wait` and is woken by the opposite side, which issues
+        notify only if somebody is actually parked, so non-blocking calls stay as cheap as before.
+
+        Timed versions can't park (see `wait::timed_backoff`) and
+        return false or nullopt, if deadline is reached.
+    */
+
+    template <wait::strategy Strategy = wait::spin_park>
+    void
+    push_wait(value_type const& v)
+    {
+        wait::backoff<Strategy> backoff;
+        while (!emplace_back_as<overflow::reject_newest>(v)) wait_not_full(backoff);
+    }
+
+    template <wait::strategy Strategy = wait::spin_park>
+    void
+    push_wait(value_type&& v)
+    {
+        wait::backoff<Strategy> backoff;
+        // rejected push doesn't touch `v`, so it's safe to move it again
+        while (!emplace_back_as<overflow::reject_newest>(std::move(v))) wait_not_full(backoff);
+    }
+
+    template <typename Clock, typename Duration>
+    bool
+    push_wait_until(value_type const& v, std::chrono::time_point<Clock, Duration> deadline)
+    {
+        wait::timed_backoff backoff{ deadline };
+        while (!emplace_back_as<overflow::reject_newest>(v))
+        {
+            m_stats.add(stats::event::spin);
+            if (!backoff()) return false;
+        }
+        return true;
+    }
+
+    template <typename Rep, typename Period>
+    bool
+    push_wait_for(value_type const& v, std::chrono::duration<Rep, Period> timeout)
+    {
+        return push_wait_until(v, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <wait::strategy Strategy = wait::spin_park>
+    value_type
+    pop_wait()
+        requires std::move_constructible<value_type>
+    {
+        wait::backoff<Strategy> backoff;
         for (;;)
         {
-            ptr = m_buf_begin + (pos & mask());
-            std::size_t const seq{ ptr->seq.load(std::memory_order::seq_cst) };
-            std::int64_t const diff{ static_cast<std::int64_t>(seq) -
-                                     static_cast<std::int64_t>(pos) };
-
-            if (diff == 0 && m_last.compare_exchange_weak(pos, pos + 1, std::memory_order::seq_cst))
-                break;
-            else
-                pos = m_last.load(std::memory_order::seq_cst);
+            if (auto v{ pop_front() }) return std::move(*v);
+            wait_not_empty(backoff);
         }
+    }
 
-        if (full())
-            m_first.fetch_add(1, std::memory_order::seq_cst);
-        else
-            m_size.fetch_add(1, std::memory_order::seq_cst);
-        ptr->value = value_type{ std::forward<decltype(args)>(args)... };
-        ptr->seq.store(pos + size_type(1), std::memory_order::seq_cst);
+    template <typename Clock, typename Duration>
+    std::optional<value_type>
+    pop_wait_until(std::chrono::time_point<Clock, Duration> deadline)
+        requires std::move_constructible<value_type>
+    {
+        wait::timed_backoff backoff{ deadline };
+        for (;;)
+        {
+            if (auto v{ pop_front() }) return v;
+            m_stats.add(stats::event::spin);
+            if (!backoff()) return std::nullopt;
+        }
     }
 
+    template <typename Rep, typename Period>
     std::optional<value_type>
-    pop_front()
+    pop_wait_for(std::chrono::duration<Rep, Period> timeout)
     {
-        pointer_impl ptr{ nullptr };
-        std::size_t pos{ m_first.load(std::memory_order::seq_cst) };
+        return pop_wait_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    /*
+        Batch versions reserve the whole range of slots with one CAS,
+        so contended index is touched once per batch instead of once per element.
+        They never wait, overwrite or partially fail in the middle:
+        only the longest available prefix of the batch is pushed or popped.
+    */
+
+    ///! copies the longest prefix of `values`, which fits in free slots
+    ///! @return count of pushed elements
+    size_type
+    try_push_n(std::span<value_type const> values)
+        requires std::copy_constructible<value_type>
+    {
+        size_type const max{ std::min<size_type>(values.size(), capacity()) };
+        size_type pos{ m_last.load(std::memory_order::relaxed) };
 
         for (;;)
         {
-            ptr = m_buf_begin + (pos & mask());
-            std::size_t const seq = ptr->seq.load(std::memory_order::seq_cst);
-            std::int64_t const diff{ static_cast<std::int64_t>(seq) -
-                                     static_cast<std::int64_t>(pos + 1) };
-
-            if (diff < 0) return std::nullopt;
-            if (diff == 0 &&
-                m_first.compare_exchange_weak(pos, pos + 1, std::memory_order::seq_cst))
-                break;
-            else
-                pos = m_first.load(std::memory_order::seq_cst);
+            size_type const n{ count_slots(pos, max, &this_type::empty_seq) };
+            if (n == 0)
+            {
+                if (max == 0) return 0;
+                if (seq_diff(pos, &this_type::empty_seq) < 0)
+                {
+                    m_stats.add(stats::event::full);
+                    return 0;
+                }
+                pos = m_last.load(std::memory_order::relaxed);
+            } else if (!m_last.compare_exchange_weak(pos, pos + n, std::memory_order::seq_cst,
+                                                     std::memory_order::relaxed))
+            {
+                m_stats.add(stats::event::push_cas_failure);
+            } else
+            {
+                if constexpr (stats::enabled<stats_policy>)
+                    m_stats.update_high_water(pos + n - m_first.load(std::memory_order::relaxed));
+
+                // free slots can't be taken by anyone else, until we publish them
+                for (size_type i{ 0 }; i < n; ++i)
+                {
+                    pointer_impl const ptr{ slot_at(pos + i) };
+                    allocator_traits_impl::construct(get_allocator_impl(), ptr->value(), values[i]);
+                    ptr->stamp = m_stats.stamp_push();
+                    ptr->seq.store(full_seq(pos + i), std::memory_order::release);
+                }
+                notify_consumers(n);
+                return n;
+            }
         }
+    }
 
-        value_type ret{ std::move(ptr->value) };
-        m_size.fetch_add(-1, std::memory_order::seq_cst);
-        ptr->seq.store(pos + mask() + size_type(1), std::memory_order::seq_cst);
+    ///! moves the longest available sequence of elements to the beginning of `out`
+    ///! @return count of popped elements
+    size_type
+    try_pop_n(std::span<value_type> out)
+        requires std::movable<value_type>
+    {
+        size_type const max{ std::min<size_type>(out.size(), capacity()) };
+        size_type pos{ m_first.load(std::memory_order::relaxed) };
 
-        return ret;
+        for (;;)
+        {
+            size_type const n{ count_slots(pos, max, &this_type::full_seq) };
+            if (n == 0)
+            {
+                if (max == 0) return 0;
+                if (seq_diff(pos, &this_type::full_seq) < 0)
+                {
+                    m_stats.add(stats::event::empty);
+                    return 0;
+                }
+                pos = m_first.load(std::memory_order::relaxed);
+            } else if (!m_first.compare_exchange_weak(pos, pos + n, std::memory_order::seq_cst,
+                                                      std::memory_order::relaxed))
+            {
+                m_stats.add(stats::event::pop_cas_failure);
+            } else
+            {
+                for (size_type i{ 0 }; i < n; ++i)
+                {
+                    pointer_impl const ptr{ slot_at(pos + i) };
+                    m_stats.record_pop(ptr->stamp);
+                    out[i] = std::move(*ptr->value());
+                    allocator_traits_impl::destroy(get_allocator_impl(), ptr->value());
+                    ptr->seq.store(empty_seq(pos + i + capacity()), std::memory_order::release);
+                }
+                notify_producers(n);
+                return n;
+            }
+        }
     }
 
     // TODO: specialize for `std:ranges::sized_range` using `drop(size(view) -
@@ -227,6 +557,277 @@ public:
     }
 
 private:
+    template <overflow::policy Policy>
+    bool
+    emplace_back_as(auto&&... args)
+    {
+        slot const s{ reserve_back_as<Policy>() };
+        if (!s) return false;
+
+        allocator_traits_impl::construct(get_allocator_impl(), s.get(),
+                                         std::forward<decltype(args)>(args)...);
+        commit_back(s);
+        return true;
+    }
+
+    template <overflow::policy Policy>
+    slot
+    reserve_back_as()
+    {
+        pointer_impl ptr{ nullptr };
+        size_type pos{ m_last.load(std::memory_order::relaxed) };
+        [[maybe_unused]] wait::backoff<wait::spin_park> backoff;
+        // overwriting producer waits for other thread, which holds the slot, not for room,
+        // so it never parks: commit of other producer doesn't wake it
+        [[maybe_unused]] wait::backoff<wait::spin_yield> overwrite_backoff;
+        [[maybe_unused]] bool was_full{ false };
+
+        // Here I use the idea of Dmitry Vyukov.
+        // https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue for details
+        // briefly, we enumerate each element by it position in ringbuf ctor and increase this
+        // number, when someone take exclusive ownership on it.
+        // So, we (read - this thread) can know, that is not we and just return false
+        for (;;)
+        {
+            ptr = m_buf_begin + (pos & mask());
+            // acquire pairs with release in `release_front`, so we don't overwrite value being read
+            std::size_t const seq{ ptr->seq.load(std::memory_order::acquire) };
+            std::int64_t const diff{ static_cast<std::int64_t>(seq - empty_seq(pos)) };
+
+            if (diff == 0)
+            {
+                // index only hands out slots, value is published by `seq`, so relaxed is enough.
+                // But seq_cst is needed for parked consumers, see `park_consumer`.
+                // On x86 it's the same lock cmpxchg anyway
+                if (m_last.compare_exchange_weak(pos, pos + 1, std::memory_order::seq_cst,
+                                                 std::memory_order::relaxed))
+                    return slot{ ptr, pos };
+                m_stats.add(stats::event::push_cas_failure);
+            } else if (diff < 0)
+            {
+                // slot still keeps element pushed `capacity()` positions ago, so we are full
+                if (!std::exchange(was_full, true)) m_stats.add(stats::event::full);
+
+                if constexpr (std::same_as<Policy, overflow::reject_newest>)
+                {
+                    return slot{};
+                } else if constexpr (std::same_as<Policy, overflow::block>)
+                {
+                    wait_not_full(backoff);
+                } else
+                {
+                    // drop element only if nobody took it yet. Otherwise consumer holds the slot
+                    // (e.g. by `try_peek_front`) and there is room, when it's released
+                    if (discard_front_at(pos - capacity()))
+                    {
+                        m_stats.add(stats::event::overwrite);
+                    } else
+                    {
+                        m_stats.add(stats::event::spin);
+                        (void)overwrite_backoff();
+                    }
+                }
+                pos = m_last.load(std::memory_order::relaxed);
+            } else
+            {
+                pos = m_last.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    // takes the oldest element, but doesn't count empty queue
+    slot
+    take_front() noexcept
+    {
+        pointer_impl ptr{ nullptr };
+        std::size_t pos{ m_first.load(std::memory_order::relaxed) };
+
+        for (;;)
+        {
+            ptr = m_buf_begin + (pos & mask());
+            // acquire pairs with release in `commit_back`, so value is visible
+            std::size_t const seq = ptr->seq.load(std::memory_order::acquire);
+            std::int64_t const diff{ static_cast<std::int64_t>(seq - full_seq(pos)) };
+
+            if (diff < 0) return slot{};
+            // seq_cst is for parked producers, see `park_producer`
+            if (diff == 0)
+            {
+                if (m_first.compare_exchange_weak(pos, pos + 1, std::memory_order::seq_cst,
+                                                  std::memory_order::relaxed))
+                    return slot{ ptr, pos };
+                m_stats.add(stats::event::pop_cas_failure);
+            } else
+            {
+                pos = m_first.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    // the same as `release_front`, but not counted as pop
+    void
+    release(slot s) noexcept
+    {
+        allocator_traits_impl::destroy(get_allocator_impl(), s.get());
+        s.m_impl->seq.store(empty_seq(s.m_pos + capacity()), std::memory_order::release);
+        notify_producers(1);
+    }
+
+    bool
+    discard_front() noexcept
+    {
+        slot const s{ take_front() };
+        if (s) release(s);
+        return static_cast<bool>(s);
+    }
+
+    // the same as `discard_front`, but only if the oldest element is at `pos` and it's published
+    bool
+    discard_front_at(size_type pos) noexcept
+    {
+        pointer_impl const ptr{ m_buf_begin + (pos & mask()) };
+        // acquire pairs with release in `commit_back`, so element is constructed
+        if (ptr->seq.load(std::memory_order::acquire) != full_seq(pos)) return false;
+        if (!m_first.compare_exchange_strong(pos, pos + 1, std::memory_order::seq_cst,
+                                             std::memory_order::relaxed))
+            return false;
+
+        release(slot{ ptr, pos });
+        return true;
+    }
+
+    /*
+        Parking is Dekker-like handshake between waiter and the opposite side:
+
+            waiter:   ++parked; load index;     notifier:   CAS index; load parked
+
+        All of them are seq_cst, so at least one sees the other: either waiter sees
+        moved index and doesn't sleep, or notifier sees waiter and wakes it.
+        Epoch is loaded before ++parked, so notify between check and sleep is not lost too.
+
+        Waiter looks at index instead of slot, because slot is published with release only.
+        So it can see reserved, but not yet published element - then it spins a bit more.
+    */
+
+    template <typename Strategy>
+    void
+    wait_not_full(wait::backoff<Strategy>& backoff)
+    {
+        m_stats.add(stats::event::spin);
+        if (backoff()) park_producer();
+    }
+
+    template <typename Strategy>
+    void
+    wait_not_empty(wait::backoff<Strategy>& backoff)
+    {
+        m_stats.add(stats::event::spin);
+        if (backoff()) park_consumer();
+    }
+
+    void
+    park_producer()
+    {
+        std::uint32_t const epoch{ m_pop_epoch.load(std::memory_order::acquire) };
+        m_parked_producers.fetch_add(1, std::memory_order::seq_cst);
+
+        size_type const first{ m_first.load(std::memory_order::seq_cst) };
+        size_type const last{ m_last.load(std::memory_order::relaxed) };
+        if (last - first >= capacity())
+        {
+            m_stats.add(stats::event::park);
+            m_pop_epoch.wait(epoch, std::memory_order::acquire);
+        }
+
+        m_parked_producers.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    void
+    park_consumer()
+    {
+        std::uint32_t const epoch{ m_push_epoch.load(std::memory_order::acquire) };
+        m_parked_consumers.fetch_add(1, std::memory_order::seq_cst);
+
+        // `first` is loaded after `last`, so it can be even greater,
+        // but then somebody pushed after our load of `last` and it will wake us
+        size_type const last{ m_last.load(std::memory_order::seq_cst) };
+        size_type const first{ m_first.load(std::memory_order::relaxed) };
+        if (static_cast<std::int64_t>(last - first) <= 0)
+        {
+            m_stats.add(stats::event::park);
+            m_push_epoch.wait(epoch, std::memory_order::acquire);
+        }
+
+        m_parked_consumers.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    // `n` elements were pushed
+    void
+    notify_consumers(size_type n)
+    {
+        if (0 == m_parked_consumers.load(std::memory_order::seq_cst)) return;
+
+        m_push_epoch.fetch_add(1, std::memory_order::release);
+        if (n == 1)
+            m_push_epoch.notify_one();
+        else
+            m_push_epoch.notify_all();
+    }
+
+    // `n` slots were freed
+    void
+    notify_producers(size_type n)
+    {
+        if (0 == m_parked_producers.load(std::memory_order::seq_cst)) return;
+
+        m_pop_epoch.fetch_add(1, std::memory_order::release);
+        if (n == 1)
+            m_pop_epoch.notify_one();
+        else
+            m_pop_epoch.notify_all();
+    }
+
+    // Each slot is used for positions `i`, `i + capacity()`, `i + 2 * capacity()`...
+    // and for each position it is at first empty, then full.
+    // Vyukov uses `pos` and `pos + 1` for these states, but they are indistinguishable
+    // from the next position when `capacity() == 1`, so I double them.
+    static constexpr size_type
+    empty_seq(size_type pos)
+    {
+        return 2 * pos;
+    }
+
+    static constexpr size_type
+    full_seq(size_type pos)
+    {
+        return 2 * pos + 1;
+    }
+
+    pointer_impl
+    slot_at(size_type pos) const
+    {
+        return m_buf_begin + (pos & mask());
+    }
+
+    // how far sequence of slot for `pos` is from expected `state(pos)`:
+    // zero - slot is ready, negative - it's still busy with previous round, positive - `pos` is stale
+    std::int64_t
+    seq_diff(size_type pos, size_type (*state)(size_type)) const
+    {
+        // acquire pairs with release of the previous owner of slot
+        std::size_t const seq{ slot_at(pos)->seq.load(std::memory_order::acquire) };
+        return static_cast<std::int64_t>(seq - state(pos));
+    }
+
+    // count of consecutive slots from `pos`, up to `max`, which are in `state`
+    size_type
+    count_slots(size_type pos, size_type max, size_type (*state)(size_type)) const
+    {
+        size_type n{ 0 };
+        while (n < max && seq_diff(pos + n, state) == 0) ++n;
+        return n;
+    }
+
     ///! @pre capacity() > 0
     size_type
     mask() const
@@ -251,17 +852,36 @@ private:
     // one is the smallest power of 2. Of course, except for negative ones))
     size_type m_capacity{ 1 };
 
-    std::atomic<size_type> m_last{ 0 };
-    std::atomic<size_type> m_first{ 0 };
-    std::atomic<size_type> m_size{ 0 };
+    // producers write `m_last`, consumers write `m_first`, so they live in different cache lines
+    alignas(detail::cache_line_size) std::atomic<size_type> m_last{ 0 };
+    alignas(detail::cache_line_size) std::atomic<size_type> m_first{ 0 };
+
+    // written only by parked threads and those who wake them, so one cache line for all
+    alignas(detail::cache_line_size) std::atomic<std::uint32_t> m_parked_producers{ 0 };
+    std::atomic<std::uint32_t> m_parked_consumers{ 0 };
+    // bumped on each notify, parked threads wait for its change
+    std::atomic<std::uint32_t> m_push_epoch{ 0 };
+    std::atomic<std::uint32_t> m_pop_epoch{ 0 };
 
     // TODO: use inheritance to optimize size of ringbuf,
     //       if allocator_type is stateless
     allocator_type_impl m_allocator;
 
+    // shards of counters are cache aligned, so they never share line with indices
+    [[no_unique_address]] stats_recorder m_stats;
+
     static_assert(decltype(m_last)::is_always_lock_free);
     static_assert(decltype(m_first)::is_always_lock_free);
-    static_assert(decltype(m_size)::is_always_lock_free);
 };
 
+namespace pmr
+{
+
+template <std::destructible T, overflow::policy OverflowPolicy = overflow::overwrite_oldest,
+          stats::policy StatsPolicy = stats::none>
+using lock_free_ringbuf =
+    tt::lock_free_ringbuf<T, std::pmr::polymorphic_allocator<T>, OverflowPolicy, StatsPolicy>;
+
+} // namespace pmr
+
 } // namespace tt
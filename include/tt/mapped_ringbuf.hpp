@@ -0,0 +1,333 @@
+#pragma once
+
+#include <tt/detail.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tt
+{
+
+/*
+    Ringbuf which lives in memory-mapped file.
+
+    Mapping is shared, so each store goes directly to page cache and
+    survives crash of process without any msync. msync is needed only to survive
+    crash of OS, so it's optional and batched (see `sync_every`).
+
+    File is just header followed by array of `T`,
+    so other process (e.g. post-mortem tool) can map it and read without any parsing.
+
+    When full, the oldest element is overwritten.
+*/
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+class mapped_ringbuf
+{
+public:
+    using this_type = mapped_ringbuf<T>;
+    using value_type = T;
+    using size_type = std::uint64_t;
+    using reference = value_type&;
+    using const_reference = value_type const&;
+
+    struct header
+    {
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t value_size;
+        size_type capacity;
+
+        // indices grow infinitely and wrap only when used to access element,
+        // so `last - first` is always size and there is no full/empty ambiguity
+        size_type first;
+        size_type last;
+    };
+
+    // "ttringbf" in little endian
+    static constexpr std::uint64_t magic{ 0x666272676e697474 };
+    static constexpr std::uint32_t version{ 1 };
+
+    ///! opens file or creates new one, if it's absent or empty
+    ///! @throws std::system_error if file can't be opened or mapped
+    ///! @throws std::runtime_error if file exists, but was created for other `T` or capacity
+    mapped_ringbuf(std::filesystem::path const& path, size_type capacity,
+                   size_type sync_every = 0)
+        : m_sync_every{ sync_every }
+    {
+        open(path, capacity);
+    }
+
+    ///! opens existing file, capacity is read from it
+    explicit mapped_ringbuf(std::filesystem::path const& path)
+    {
+        open(path, std::nullopt);
+    }
+
+    mapped_ringbuf(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    mapped_ringbuf(this_type&& other) noexcept
+        : m_fd{ std::exchange(other.m_fd, -1) }
+        , m_map{ std::exchange(other.m_map, nullptr) }
+        , m_map_size{ std::exchange(other.m_map_size, 0) }
+        , m_header{ std::exchange(other.m_header, nullptr) }
+        , m_data{ std::exchange(other.m_data, nullptr) }
+        , m_sync_every{ other.m_sync_every }
+        , m_unsynced{ other.m_unsynced }
+    {
+    }
+
+    this_type&
+    operator=(this_type&& other) noexcept
+    {
+        this_type tmp{ std::move(other) };
+        swap(*this, tmp);
+        return *this;
+    }
+
+    ~mapped_ringbuf()
+    {
+        close();
+    }
+
+    friend void
+    swap(this_type& lhs, this_type& rhs) noexcept
+    {
+        using std::swap;
+
+        swap(lhs.m_fd, rhs.m_fd);
+        swap(lhs.m_map, rhs.m_map);
+        swap(lhs.m_map_size, rhs.m_map_size);
+        swap(lhs.m_header, rhs.m_header);
+        swap(lhs.m_data, rhs.m_data);
+        swap(lhs.m_sync_every, rhs.m_sync_every);
+        swap(lhs.m_unsynced, rhs.m_unsynced);
+    }
+
+    size_type
+    size() const noexcept
+    {
+        return load(m_header->last) - load(m_header->first);
+    }
+
+    size_type
+    capacity() const noexcept
+    {
+        return m_header->capacity;
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return 0 == size();
+    }
+
+    bool
+    full() const noexcept
+    {
+        return capacity() == size();
+    }
+
+    void
+    push_back(value_type const& v)
+    {
+        if (capacity() == 0) return;
+
+        size_type const first{ load(m_header->first) };
+        size_type const last{ load(m_header->last) };
+
+        // the oldest element leaves buffer before it is overwritten,
+        // so crash in the middle of push never exposes half-written element
+        if (last - first == capacity()) store(m_header->first, first + 1);
+        m_data[last % capacity()] = v;
+        store(m_header->last, last + 1);
+
+        if (m_sync_every != 0 && ++m_unsynced == m_sync_every) flush();
+    }
+
+    std::optional<value_type>
+    pop_front()
+    {
+        if (empty()) return std::nullopt;
+
+        size_type const first{ load(m_header->first) };
+        value_type ret{ m_data[first % capacity()] };
+        store(m_header->first, first + 1);
+        return ret;
+    }
+
+    void
+    clear() noexcept
+    {
+        store(m_header->first, load(m_header->last));
+    }
+
+    ///! @pre i < size()
+    const_reference
+    operator[](size_type i) const
+    {
+        assert(i < size());
+        return m_data[(load(m_header->first) + i) % capacity()];
+    }
+
+    ///! @pre !empty()
+    const_reference
+    front() const
+    {
+        return (*this)[0];
+    }
+
+    ///! @pre !empty()
+    const_reference
+    back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    ///! elements from the oldest to the newest
+    auto
+    items() const
+    {
+        return std::views::iota(size_type{ 0 }, size()) |
+               std::views::transform([this](size_type i) -> const_reference
+                                     { return (*this)[i]; });
+    }
+
+    ///! @param wait if true, returns only when data is on disk
+    void
+    flush(bool wait = false)
+    {
+        m_unsynced = 0;
+        if (0 != ::msync(m_map, m_map_size, wait ? MS_SYNC : MS_ASYNC))
+            throw std::system_error(errno, std::generic_category(), "mapped_ringbuf: msync");
+    }
+
+private:
+    static constexpr std::size_t data_offset{
+        detail::divceil(sizeof(header), alignof(value_type)) * alignof(value_type)
+    };
+
+    static std::size_t
+    file_size(size_type capacity)
+    {
+        return data_offset + capacity * sizeof(value_type);
+    }
+
+    // header is shared with other processes, so at least compiler must not reorder
+    // stores of indices with stores of elements
+    static size_type
+    load(size_type const& index)
+    {
+        // atomic_ref<T const> is only C++26
+        auto& mutable_index{ const_cast<size_type&>(index) };
+        return std::atomic_ref<size_type>{ mutable_index }.load(std::memory_order::acquire);
+    }
+
+    static void
+    store(size_type& index, size_type v)
+    {
+        std::atomic_ref<size_type>{ index }.store(v, std::memory_order::release);
+    }
+
+    void
+    close() noexcept
+    {
+        if (nullptr != m_map) ::munmap(m_map, m_map_size);
+        if (-1 != m_fd) ::close(m_fd);
+        m_map = nullptr;
+        m_fd = -1;
+    }
+
+    // dtor is not called if ctor throws, so close everything opened so far
+    void
+    open(std::filesystem::path const& path, std::optional<size_type> capacity)
+    {
+        try
+        {
+            open_or_throw(path, capacity);
+        } catch (...)
+        {
+            close();
+            throw;
+        }
+    }
+
+    void
+    open_or_throw(std::filesystem::path const& path, std::optional<size_type> capacity)
+    {
+        auto const fail = [](char const* what)
+        { throw std::system_error(errno, std::generic_category(), what); };
+
+        m_fd = ::open(path.c_str(), capacity ? O_RDWR | O_CREAT : O_RDWR, 0644);
+        if (-1 == m_fd) fail("mapped_ringbuf: open");
+
+        struct stat st;
+        if (0 != ::fstat(m_fd, &st)) fail("mapped_ringbuf: fstat");
+        bool const fresh{ st.st_size == 0 };
+
+        if (fresh)
+        {
+            if (!capacity) throw std::runtime_error("mapped_ringbuf: file is empty");
+            if (0 != ::ftruncate(m_fd, static_cast<off_t>(file_size(*capacity))))
+                fail("mapped_ringbuf: ftruncate");
+            m_map_size = file_size(*capacity);
+        } else
+        {
+            if (static_cast<std::size_t>(st.st_size) < sizeof(header))
+                throw std::runtime_error("mapped_ringbuf: file is too small");
+            m_map_size = static_cast<std::size_t>(st.st_size);
+        }
+
+        m_map = ::mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (MAP_FAILED == m_map)
+        {
+            m_map = nullptr;
+            fail("mapped_ringbuf: mmap");
+        }
+        m_header = static_cast<header*>(m_map);
+        m_data = reinterpret_cast<value_type*>(static_cast<std::byte*>(m_map) + data_offset);
+
+        if (fresh)
+        {
+            *m_header = header{ .magic = magic,
+                                .version = version,
+                                .value_size = sizeof(value_type),
+                                .capacity = *capacity,
+                                .first = 0,
+                                .last = 0 };
+            return;
+        }
+
+        bool const compatible{ m_header->magic == magic && m_header->version == version &&
+                               m_header->value_size == sizeof(value_type) &&
+                               m_map_size == file_size(m_header->capacity) &&
+                               (!capacity || *capacity == m_header->capacity) };
+        if (!compatible) throw std::runtime_error("mapped_ringbuf: incompatible file");
+    }
+
+    int m_fd{ -1 };
+    void* m_map{ nullptr };
+    std::size_t m_map_size{ 0 };
+
+    header* m_header{ nullptr };
+    value_type* m_data{ nullptr };
+
+    size_type m_sync_every{ 0 };
+    size_type m_unsynced{ 0 };
+};
+
+} // namespace tt
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <tt/detail.hpp>
+#include <tt/overflow.hpp>
+#include <tt/wait.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tt
+{
+
+/*
+    Single writer, multi reader ring buffer in the style of LMAX Disruptor.
+
+    Elements are not consumed: each reader has its own cursor (sequence of the next element
+    it reads), so one stream feeds several readers, e.g. recorder, network sender and
+    analytics, without copying it to several queues.
+
+    Reader can depend on other readers, then it never overtakes them (sequence barrier),
+    e.g. sender reads only what recorder already saved. Reader reads in batches: it takes
+    everything available at once and publishes its cursor once per batch.
+
+    With `overflow::block` writer waits for the slowest gating reader, i.e. reader,
+    which nobody depends on, because others are ahead of it anyway. Writer caches cursor
+    of the slowest one and rescans readers only when buffer looks full.
+    Readers then access elements in place.
+
+    With `overflow::overwrite_oldest` writer never waits and never looks at readers.
+    Reader, which is lapped by writer, notices it, skips lost elements (see `reader::lost`)
+    and continues from the oldest one, which is still in buffer. Element can be overwritten
+    while reader copies it, so here `T` must be trivially copyable, slots are
+    seqlocks of atomic words and reader gets a copy.
+
+    Readers must be added before the first push.
+*/
+template <std::default_initializable T, typename Alloc = std::allocator<T>,
+          overflow::policy OverflowPolicy = overflow::block>
+class multicast_ringbuf
+{
+    static_assert(std::same_as<OverflowPolicy, overflow::block> ||
+                      std::same_as<OverflowPolicy, overflow::overwrite_oldest>,
+                  "writer doesn't own elements, so it can only wait for readers or lap them");
+    static_assert(!std::same_as<OverflowPolicy, overflow::overwrite_oldest> ||
+                      std::is_trivially_copyable_v<T>,
+                  "lapped reader can see torn element, so it must be trivially copyable");
+
+public:
+    using this_type = multicast_ringbuf<T, Alloc, OverflowPolicy>;
+
+    using allocator_type = Alloc;
+    using overflow_policy = OverflowPolicy;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using value_type = allocator_traits::value_type;
+    using size_type = allocator_traits::size_type;
+
+    class reader;
+
+private:
+    static constexpr bool can_lap{ std::same_as<overflow_policy, overflow::overwrite_oldest> };
+
+    // used only with `overflow::overwrite_oldest`.
+    // `seq` is `2 * pos` while `pos` is written and `2 * pos + 1` when it's published
+    struct lapped_slot
+    {
+        static constexpr std::size_t words_count{
+            detail::divceil(sizeof(value_type), sizeof(std::uint64_t))
+        };
+
+        std::atomic<size_type> seq{ 0 };
+        std::array<std::atomic<std::uint64_t>, words_count> words{};
+
+        void
+        store(size_type pos, value_type const& v) noexcept
+        {
+            std::array<std::uint64_t, words_count> tmp{};
+            std::memcpy(tmp.data(), &v, sizeof(value_type));
+
+            seq.store(2 * pos, std::memory_order::relaxed);
+            // readers must not see new words with old `seq`
+            std::atomic_thread_fence(std::memory_order::release);
+            for (std::size_t i{ 0 }; i < words_count; ++i)
+                words[i].store(tmp[i], std::memory_order::relaxed);
+            seq.store(2 * pos + 1, std::memory_order::release);
+        }
+
+        ///! @return false, if `pos` is already overwritten
+        bool
+        load(size_type pos, value_type& out) const noexcept
+        {
+            if (seq.load(std::memory_order::acquire) != 2 * pos + 1) return false;
+
+            std::array<std::uint64_t, words_count> tmp;
+            for (std::size_t i{ 0 }; i < words_count; ++i)
+                tmp[i] = words[i].load(std::memory_order::relaxed);
+            // words must be read before the second check of `seq`
+            std::atomic_thread_fence(std::memory_order::acquire);
+            if (seq.load(std::memory_order::relaxed) != 2 * pos + 1) return false;
+
+            std::memcpy(&out, tmp.data(), sizeof(value_type));
+            return true;
+        }
+    };
+
+    using slot_type = std::conditional_t<can_lap, lapped_slot, value_type>;
+    using slot_allocator = allocator_traits::template rebind_alloc<slot_type>;
+    using slot_allocator_traits = std::allocator_traits<slot_allocator>;
+
+public:
+    /*
+        Cursor of one reader. It's owned by ringbuf and
+        must be used only by one thread at a time.
+    */
+    class reader
+    {
+    public:
+        reader(reader const&) = delete;
+        reader& operator=(reader const&) = delete;
+
+        ///! sequence of the next element to read
+        size_type
+        cursor() const noexcept
+        {
+            return m_cursor.load(std::memory_order::relaxed);
+        }
+
+        ///! count of elements, which can be read now
+        size_type
+        available() const noexcept
+        {
+            size_type const limit{ barrier() };
+            size_type const cursor{ m_cursor.load(std::memory_order::relaxed) };
+            // lapped reader can jump over its dependencies
+            return limit > cursor ? limit - cursor : 0;
+        }
+
+        ///! count of elements skipped, because writer lapped this reader.
+        ///! Always zero with `overflow::block`
+        size_type
+        lost() const noexcept
+        {
+            return m_lost;
+        }
+
+        ///! calls `fn` for each available element, but no more than `max`
+        ///! @return count of elements passed to `fn`
+        size_type
+        poll(std::invocable<value_type const&> auto&& fn,
+             size_type max = std::numeric_limits<size_type>::max())
+        {
+            size_type const first{ m_cursor.load(std::memory_order::relaxed) };
+            size_type const last{ first + std::min(available(), max) };
+
+            size_type pos{ first };
+            if constexpr (can_lap)
+            {
+                size_type delivered{ 0 };
+                value_type v;
+                while (pos < last)
+                {
+                    if (m_ring->slot_at(pos).load(pos, v))
+                    {
+                        std::invoke(fn, std::as_const(v));
+                        ++pos;
+                        ++delivered;
+                        continue;
+                    }
+
+                    // lapped, jump to the oldest element, which can be still in buffer.
+                    // If writer is overwriting it right now, we will jump again
+                    size_type const cursor{ m_ring->m_cursor.load(std::memory_order::acquire) };
+                    size_type const oldest{ std::max(pos + 1, cursor - m_ring->capacity()) };
+                    m_lost += oldest - pos;
+                    pos = oldest;
+                }
+
+                m_cursor.store(pos, std::memory_order::release);
+                return delivered;
+            } else
+            {
+                for (; pos < last; ++pos) std::invoke(fn, std::as_const(m_ring->slot_at(pos)));
+
+                // one store per batch, writer and dependent readers see the whole batch at once
+                m_cursor.store(last, std::memory_order::release);
+                return last - first;
+            }
+        }
+
+        ///! waits until something is available and then polls, see `poll`
+        template <wait::strategy Strategy = wait::spin_yield>
+            requires(!Strategy::parks)
+        size_type
+        poll_wait(std::invocable<value_type const&> auto&& fn,
+                  size_type max = std::numeric_limits<size_type>::max())
+        {
+            wait::backoff<Strategy> backoff;
+            while (0 == available()) (void)backoff();
+            return poll(fn, max);
+        }
+
+    private:
+        friend this_type;
+
+        explicit reader(this_type const* ring)
+            : m_ring{ ring }
+        {
+        }
+
+        // sequence after the last element, which can be read:
+        // published by writer and already read by all dependencies
+        size_type
+        barrier() const noexcept
+        {
+            size_type limit{ m_ring->m_cursor.load(std::memory_order::acquire) };
+            for (reader const* d : m_dependencies)
+                limit = std::min(limit, d->m_cursor.load(std::memory_order::acquire));
+            return limit;
+        }
+
+        // written by reader, read by writer and dependent readers
+        alignas(detail::cache_line_size) std::atomic<size_type> m_cursor{ 0 };
+
+        this_type const* m_ring;
+        std::vector<reader const*> m_dependencies;
+        // nobody depends on it
+        bool m_gating{ true };
+        size_type m_lost{ 0 };
+    };
+
+    ///! @pre `capacity` is power of 2
+    explicit multicast_ringbuf(size_type capacity, allocator_type const& alloc = allocator_type())
+        : m_allocator{ alloc }
+        , m_capacity{ capacity }
+    {
+        assert(detail::is_power_of_2(capacity));
+
+        m_slots = slot_allocator_traits::allocate(m_allocator, capacity);
+        for (size_type i{ 0 }; i < capacity; ++i)
+            slot_allocator_traits::construct(m_allocator, m_slots + i);
+    }
+
+    multicast_ringbuf(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    ~multicast_ringbuf()
+    {
+        for (size_type i{ 0 }; i < capacity(); ++i)
+            slot_allocator_traits::destroy(m_allocator, m_slots + i);
+        slot_allocator_traits::deallocate(m_allocator, m_slots, capacity());
+    }
+
+    ///! new reader never overtakes `dependencies`
+    ///! @pre it's called before the first push and dependencies are readers of this ringbuf
+    reader&
+    add_reader(std::initializer_list<reader*> dependencies = {})
+    {
+        m_readers.push_back(std::unique_ptr<reader>{ new reader{ this } });
+        reader& r{ *m_readers.back() };
+        r.m_dependencies.assign(dependencies.begin(), dependencies.end());
+
+        // writer waits only for the ends of chains, others are ahead of them
+        for (reader* d : dependencies)
+        {
+            assert(d->m_ring == this);
+            d->m_gating = false;
+        }
+        return r;
+    }
+
+    size_type
+    capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    ///! count of published elements, i.e. sequence of the next one
+    size_type
+    cursor() const noexcept
+    {
+        return m_cursor.load(std::memory_order::relaxed);
+    }
+
+    ///! writer only.
+    ///! With `overflow::block` waits, while the slowest gating reader is `capacity()` behind
+    void
+    push(value_type const& v)
+    {
+        wait_room();
+        write(v);
+    }
+
+    void
+    push(value_type&& v)
+    {
+        wait_room();
+        write(std::move(v));
+    }
+
+    ///! writer only
+    ///! @return false, if the slowest gating reader is `capacity()` behind
+    bool
+    try_push(value_type const& v)
+        requires(!can_lap)
+    {
+        if (!has_room()) return false;
+        write(v);
+        return true;
+    }
+
+private:
+    void
+    wait_room() noexcept
+    {
+        if constexpr (!can_lap)
+        {
+            wait::backoff<wait::spin_yield> backoff;
+            while (!has_room()) (void)backoff();
+        }
+    }
+
+    bool
+    has_room() noexcept
+    {
+        size_type const seq{ m_cursor.load(std::memory_order::relaxed) };
+        if (seq - m_cached_gate < capacity()) return true;
+
+        m_cached_gate = seq;
+        for (auto const& r : m_readers)
+        {
+            // acquire pairs with release in `poll`, so reader is done with slot
+            if (!r->m_gating) continue;
+            m_cached_gate = std::min(m_cached_gate, r->m_cursor.load(std::memory_order::acquire));
+        }
+        return seq - m_cached_gate < capacity();
+    }
+
+    void
+    write(auto&& v)
+    {
+        size_type const seq{ m_cursor.load(std::memory_order::relaxed) };
+        if constexpr (can_lap)
+            slot_at(seq).store(seq, v);
+        else
+            slot_at(seq) = std::forward<decltype(v)>(v);
+        m_cursor.store(seq + 1, std::memory_order::release);
+    }
+
+    slot_type&
+    slot_at(size_type pos) const noexcept
+    {
+        return m_slots[pos & (capacity() - 1)];
+    }
+
+    [[no_unique_address]] slot_allocator m_allocator;
+    slot_type* m_slots{ nullptr };
+    size_type m_capacity{ 0 };
+
+    std::vector<std::unique_ptr<reader>> m_readers;
+
+    // written only by writer
+    alignas(detail::cache_line_size) std::atomic<size_type> m_cursor{ 0 };
+    // the slowest gating reader, when it was checked the last time
+    size_type m_cached_gate{ 0 };
+};
+
+namespace pmr
+{
+
+template <std::default_initializable T, overflow::policy OverflowPolicy = overflow::block>
+using multicast_ringbuf =
+    tt::multicast_ringbuf<T, std::pmr::polymorphic_allocator<T>, OverflowPolicy>;
+
+} // namespace pmr
+
+} // namespace tt
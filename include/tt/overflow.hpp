@@ -0,0 +1,39 @@
+#pragma once
+
+#include <concepts>
+
+namespace tt::overflow
+{
+
+/*
+    What a ring buffer does on push, when it is `full()`.
+
+    Policy is a tag type passed as template parameter,
+    so the branch is chosen at compile time and others just don't exist in the hot path.
+*/
+
+///! drop the oldest element and put the new one in its place
+struct overwrite_oldest
+{
+};
+
+///! keep buffer as is and refuse the new element, `try_push` reports it
+struct reject_newest
+{
+};
+
+///! wait until someone pops an element. Makes sense only for concurrent containers
+struct block
+{
+};
+
+///! reallocate storage to the twice capacity, so nothing is lost
+struct grow
+{
+};
+
+template <typename P>
+concept policy = std::same_as<P, overwrite_oldest> || std::same_as<P, reject_newest> ||
+                 std::same_as<P, block> || std::same_as<P, grow>;
+
+} // namespace tt::overflow
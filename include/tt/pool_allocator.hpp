@@ -0,0 +1,456 @@
+#pragma once
+
+#include <tt/detail.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+
+namespace tt
+{
+
+/*
+    Lock-free pool of fixed-size blocks, which are carved out of one chunk.
+
+    Free blocks are kept in a stack of indices: `next` of each block lives in separate
+    array, and head is index with tag in one 64-bit atomic, so CAS is not fooled by ABA.
+
+    Each thread also caches a few free blocks of up to 4 pools, so in steady state
+    allocation and deallocation don't touch shared head at all. Cache is flushed to the shared
+    stack by half, when it's full, and completely, when thread exits.
+    If thread keeps blocks of 4 other pools, it goes straight to the shared stack, instead of
+    evicting their cache: eviction locks global mutex, because that pool can be already dead.
+    Only exit of thread takes this mutex.
+
+    Requests, which are bigger than block, or aligned stricter than it, or come when
+    pool is exhausted, go to global `operator new`. They are counted as misses, see `stats`.
+*/
+class block_pool
+{
+public:
+    using size_type = std::size_t;
+
+    ///! counters are approximate, while other threads allocate concurrently
+    struct stats
+    {
+        // served from pool
+        size_type hits{ 0 };
+        // passed to `operator new`
+        size_type misses{ 0 };
+    };
+
+    ///! count of free blocks, which one thread can keep for itself
+    static constexpr size_type thread_cache_capacity{ 32 };
+
+    ///! @pre `alignment` is power of 2 and `blocks_count` < 2^32 - 1
+    block_pool(size_type block_size, size_type blocks_count,
+               size_type alignment = alignof(std::max_align_t))
+        : m_block_size{ detail::divceil(std::max<size_type>(block_size, 1), alignment) * alignment }
+        , m_blocks_count{ blocks_count }
+        , m_alignment{ alignment }
+        , m_id{ next_id() }
+    {
+        assert(detail::is_power_of_2(alignment));
+        assert(blocks_count < nil);
+
+        m_chunk = static_cast<std::byte*>(
+            ::operator new(m_block_size * m_blocks_count, std::align_val_t{ m_alignment }));
+        m_next = std::make_unique<std::atomic<std::uint32_t>[]>(m_blocks_count);
+        for (size_type i{ 0 }; i < m_blocks_count; ++i)
+            m_next[i].store(i + 1 < m_blocks_count ? static_cast<std::uint32_t>(i + 1) : nil,
+                            std::memory_order::relaxed);
+        m_head.store(pack(m_blocks_count > 0 ? 0 : nil, 0), std::memory_order::relaxed);
+
+        std::scoped_lock const lock{ registry_mutex() };
+        registry().emplace(m_id, this);
+    }
+
+    block_pool(block_pool const&) = delete;
+    block_pool& operator=(block_pool const&) = delete;
+
+    ///! @pre all blocks are deallocated
+    ~block_pool()
+    {
+        {
+            // waits for threads, which flush their caches to this pool right now
+            std::scoped_lock const lock{ registry_mutex() };
+            registry().erase(m_id);
+        }
+        ::operator delete(m_chunk, std::align_val_t{ m_alignment });
+    }
+
+    size_type
+    block_size() const noexcept
+    {
+        return m_block_size;
+    }
+
+    size_type
+    blocks_count() const noexcept
+    {
+        return m_blocks_count;
+    }
+
+    size_type
+    alignment() const noexcept
+    {
+        return m_alignment;
+    }
+
+    bool
+    owns(void const* p) const noexcept
+    {
+        auto const* b{ static_cast<std::byte const*>(p) };
+        return std::less_equal<>{}(m_chunk, b) &&
+               std::less<>{}(b, m_chunk + m_block_size * m_blocks_count);
+    }
+
+    stats
+    get_stats() const noexcept
+    {
+        stats s;
+        for (auto const& c : m_counters)
+        {
+            s.hits += c.hits.load(std::memory_order::relaxed);
+            s.misses += c.misses.load(std::memory_order::relaxed);
+        }
+        return s;
+    }
+
+    ///! @throws std::bad_alloc if pool misses and `operator new` fails
+    void*
+    allocate(size_type bytes, size_type alignment = alignof(std::max_align_t))
+    {
+        if (bytes <= m_block_size && alignment <= m_alignment)
+        {
+            if (std::uint32_t const i{ pop() }; i != nil)
+            {
+                count(&counters::hits);
+                return m_chunk + i * m_block_size;
+            }
+        }
+
+        count(&counters::misses);
+        return ::operator new(bytes, std::align_val_t{ alignment });
+    }
+
+    void
+    deallocate(void* p, size_type bytes, size_type alignment = alignof(std::max_align_t)) noexcept
+    {
+        if (!owns(p))
+        {
+            ::operator delete(p, bytes, std::align_val_t{ alignment });
+            return;
+        }
+
+        push(static_cast<std::uint32_t>((static_cast<std::byte*>(p) - m_chunk) / m_block_size));
+    }
+
+    ///! returns blocks cached by the calling thread to the shared stack
+    void
+    flush_thread_cache() noexcept
+    {
+        if (thread_cache* const c{ caches().find(m_id) }) flush(*c, c->count);
+    }
+
+private:
+    static constexpr std::uint32_t nil{ std::numeric_limits<std::uint32_t>::max() };
+
+    struct thread_cache
+    {
+        std::uint64_t pool_id{ 0 };
+        size_type count{ 0 };
+        std::array<std::uint32_t, thread_cache_capacity> blocks;
+    };
+
+    // caches of one thread for the last few pools it used
+    struct thread_caches
+    {
+        static constexpr size_type capacity{ 4 };
+
+        std::array<thread_cache, capacity> entries{};
+
+        ~thread_caches()
+        {
+            for (auto& c : entries) release(c);
+        }
+
+        thread_cache*
+        find(std::uint64_t pool_id) noexcept
+        {
+            for (auto& c : entries)
+            {
+                if (c.pool_id == pool_id) return &c;
+            }
+            return nullptr;
+        }
+
+        // cache of the pool, or empty entry given to it.
+        // nullptr, if all entries keep blocks of other pools
+        thread_cache*
+        acquire(std::uint64_t pool_id) noexcept
+        {
+            if (thread_cache* const c{ find(pool_id) }) return c;
+
+            for (auto& c : entries)
+            {
+                if (c.count != 0) continue;
+                c.pool_id = pool_id;
+                return &c;
+            }
+            return nullptr;
+        }
+
+        // pool can be already dead, so it's looked up by id
+        static void
+        release(thread_cache& c) noexcept
+        {
+            if (c.count > 0)
+            {
+                std::scoped_lock const lock{ registry_mutex() };
+                auto const pool{ registry().find(c.pool_id) };
+                if (pool != registry().end()) pool->second->flush(c, c.count);
+            }
+            c = thread_cache{};
+        }
+    };
+
+    struct alignas(detail::cache_line_size) counters
+    {
+        std::atomic<size_type> hits{ 0 };
+        std::atomic<size_type> misses{ 0 };
+    };
+
+    // counters are sharded by thread, so statistics don't make all threads write one line
+    static constexpr size_type counters_count{ 16 };
+
+    static thread_caches&
+    caches() noexcept
+    {
+        thread_local thread_caches c;
+        return c;
+    }
+
+    // pools are identified by id, not by address, because address can be reused by new pool,
+    // while thread caches still keep blocks of the old one
+    static std::uint64_t
+    next_id() noexcept
+    {
+        static std::atomic<std::uint64_t> id{ 1 };
+        return id.fetch_add(1, std::memory_order::relaxed);
+    }
+
+    static std::mutex&
+    registry_mutex() noexcept
+    {
+        static std::mutex m;
+        return m;
+    }
+
+    // alive pools, used only when thread cache is released
+    static std::unordered_map<std::uint64_t, block_pool*>&
+    registry() noexcept
+    {
+        static std::unordered_map<std::uint64_t, block_pool*> r;
+        return r;
+    }
+
+    void
+    count(std::atomic<size_type> counters::*counter) noexcept
+    {
+        (m_counters[detail::thread_index() % counters_count].*counter)
+            .fetch_add(1, std::memory_order::relaxed);
+    }
+
+    std::uint32_t
+    pop() noexcept
+    {
+        thread_cache* const cache{ caches().acquire(m_id) };
+        if (cache == nullptr) return pop_shared();
+
+        thread_cache& c{ *cache };
+        if (c.count == 0)
+        {
+            // refill a half, so the next deallocations don't flush it at once
+            while (c.count < thread_cache_capacity / 2)
+            {
+                std::uint32_t const i{ pop_shared() };
+                if (i == nil) break;
+                c.blocks[c.count++] = i;
+            }
+            if (c.count == 0) return nil;
+        }
+        return c.blocks[--c.count];
+    }
+
+    void
+    push(std::uint32_t i) noexcept
+    {
+        thread_cache* const c{ caches().acquire(m_id) };
+        if (c == nullptr)
+        {
+            push_shared(i, i);
+            return;
+        }
+
+        if (c->count == thread_cache_capacity) flush(*c, thread_cache_capacity / 2);
+        c->blocks[c->count++] = i;
+    }
+
+    std::uint32_t
+    pop_shared() noexcept
+    {
+        std::uint64_t head{ m_head.load(std::memory_order::acquire) };
+        while (index_of(head) != nil)
+        {
+            // block can be popped and reused by other thread meanwhile, but `next` is
+            // separate atomic, so it's safe to read, and tag makes CAS fail then
+            std::uint32_t const next{ m_next[index_of(head)].load(std::memory_order::relaxed) };
+            if (m_head.compare_exchange_weak(head, pack(next, tag_of(head) + 1),
+                                             std::memory_order::acquire,
+                                             std::memory_order::acquire))
+                return index_of(head);
+        }
+        return nil;
+    }
+
+    // pushes the last `n` blocks of cache as one chain
+    void
+    flush(thread_cache& c, size_type n) noexcept
+    {
+        if (n == 0) return;
+
+        std::uint32_t const* const chain{ c.blocks.data() + c.count - n };
+        for (size_type i{ 0 }; i + 1 < n; ++i)
+            m_next[chain[i]].store(chain[i + 1], std::memory_order::relaxed);
+        c.count -= n;
+
+        push_shared(chain[0], chain[n - 1]);
+    }
+
+    // pushes chain of blocks, which are already linked from `first` to `last`
+    void
+    push_shared(std::uint32_t first, std::uint32_t last) noexcept
+    {
+        std::uint64_t head{ m_head.load(std::memory_order::relaxed) };
+        do
+        {
+            m_next[last].store(index_of(head), std::memory_order::relaxed);
+        } while (!m_head.compare_exchange_weak(head, pack(first, tag_of(head) + 1),
+                                               std::memory_order::release,
+                                               std::memory_order::relaxed));
+    }
+
+    static constexpr std::uint64_t
+    pack(std::uint32_t index, std::uint32_t tag) noexcept
+    {
+        return (static_cast<std::uint64_t>(tag) << 32) | index;
+    }
+
+    static constexpr std::uint32_t
+    index_of(std::uint64_t head) noexcept
+    {
+        return static_cast<std::uint32_t>(head);
+    }
+
+    static constexpr std::uint32_t
+    tag_of(std::uint64_t head) noexcept
+    {
+        return static_cast<std::uint32_t>(head >> 32);
+    }
+
+    size_type m_block_size;
+    size_type m_blocks_count;
+    size_type m_alignment;
+    std::uint64_t m_id;
+
+    std::byte* m_chunk{ nullptr };
+    std::unique_ptr<std::atomic<std::uint32_t>[]> m_next;
+
+    alignas(detail::cache_line_size) std::atomic<std::uint64_t> m_head{ 0 };
+    std::array<counters, counters_count> m_counters;
+};
+
+/*
+    Allocator over `block_pool`, so it can be `Alloc` of containers,
+    e.g. `ringbuf`, `lock_free_ringbuf` or `counting_sort`.
+    All rebound copies share the same pool.
+
+    Default constructed allocator has no pool and just calls `operator new`.
+*/
+template <typename T>
+class pool_allocator
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    // memory must go back to the pool it came from
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    pool_allocator() noexcept = default;
+
+    explicit pool_allocator(block_pool& pool) noexcept
+        : m_pool{ &pool }
+    {
+    }
+
+    template <typename U>
+    pool_allocator(pool_allocator<U> const& other) noexcept
+        : m_pool{ other.pool() }
+    {
+    }
+
+    ///! nullptr, if allocator is default constructed
+    block_pool*
+    pool() const noexcept
+    {
+        return m_pool;
+    }
+
+    [[nodiscard]] T*
+    allocate(size_type n)
+    {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+            throw std::bad_array_new_length{};
+
+        if (m_pool == nullptr)
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ alignof(T) }));
+        return static_cast<T*>(m_pool->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void
+    deallocate(T* p, size_type n) noexcept
+    {
+        if (m_pool == nullptr)
+            ::operator delete(p, n * sizeof(T), std::align_val_t{ alignof(T) });
+        else
+            m_pool->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    friend bool
+    operator==(pool_allocator const& lhs, pool_allocator<U> const& rhs) noexcept
+    {
+        return lhs.pool() == rhs.pool();
+    }
+
+private:
+    block_pool* m_pool{ nullptr };
+};
+
+} // namespace tt
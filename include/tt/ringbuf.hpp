@@ -1,23 +1,33 @@
 #pragma once
 
 #include <tt/detail.hpp>
+#include <tt/overflow.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <compare>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <ranges>
 #include <utility>
 
 namespace tt
 {
 
-template <std::semiregular T, typename Alloc = std::allocator<T>>
+template <std::destructible T, typename Alloc = std::allocator<T>,
+          overflow::policy OverflowPolicy = overflow::overwrite_oldest>
 class ringbuf
 {
+    static_assert(!std::same_as<OverflowPolicy, overflow::block>,
+                  "nobody will pop element from single-threaded ringbuf, while push is blocked");
+
 public:
-    using this_type = ringbuf<T, Alloc>;
+    using this_type = ringbuf<T, Alloc, OverflowPolicy>;
     using allocator_type = Alloc;
+    using overflow_policy = OverflowPolicy;
 
     using allocator_traits = std::allocator_traits<allocator_type>;
     using value_type = allocator_traits::value_type;
@@ -31,11 +41,19 @@ public:
     using size_type = allocator_traits::size_type;
 
 private:
+    static constexpr bool propagate_on_copy{
+        allocator_traits::propagate_on_container_copy_assignment::value
+    };
+    static constexpr bool propagate_on_move{
+        allocator_traits::propagate_on_container_move_assignment::value
+    };
+    static constexpr bool propagate_on_swap{
+        allocator_traits::propagate_on_container_swap::value
+    };
+
     void
-    init_with_capacity_and_allocator(size_type sz, allocator_type const& alloc = allocator_type())
+    init_with_capacity(size_type sz)
     {
-        m_allocator = alloc;
-
         m_buf = allocator_traits::allocate(get_allocator(), sz);
         m_end = m_buf + sz;
 
@@ -49,24 +67,75 @@ public:
     ringbuf(size_type sz, allocator_type const& alloc = allocator_type())
         : m_allocator{ alloc }
     {
-        init_with_capacity_and_allocator(sz, alloc);
+        init_with_capacity(sz);
     }
 
+    // NOTE: allocator is chosen by `select_on_container_copy_construction`,
+    //       e.g. copy of `pmr::ringbuf` uses default memory resource, not the one of `other`
     ringbuf(this_type const& other)
+        : ringbuf(other,
+                  allocator_traits::select_on_container_copy_construction(other.get_allocator()))
     {
-        init_with_capacity_and_allocator(other.capacity(), other.get_allocator());
+    }
+
+    ringbuf(this_type const& other, allocator_type const& alloc)
+        : m_allocator{ alloc }
+    {
+        init_with_capacity(other.capacity());
         assign(std::ranges::ref_view(other));
     }
+
+    // NOTE: `owning_view` of ringbuf would move it again, so just steal the storage
     ringbuf(this_type&& other) noexcept
+        : m_allocator{ other.get_allocator() }
+    {
+        init_with_capacity(0);
+        swap_storage(*this, other);
+    }
+
+    ///! steals storage of `other` only if allocators are equal, otherwise moves elements
+    ringbuf(this_type&& other, allocator_type const& alloc)
+        : m_allocator{ alloc }
     {
-        init_with_capacity_and_allocator(other.capacity(), other.get_allocator());
-        assign(std::ranges::owning_view(std::forward<this_type>(other)));
+        if (get_allocator() == other.get_allocator())
+        {
+            init_with_capacity(0);
+            swap_storage(*this, other);
+            return;
+        }
+
+        init_with_capacity(other.capacity());
+        for (value_type& v : other) emplace_back(std::move(v));
     }
 
+    ///! keeps own allocator, unless it propagates on copy assignment
     this_type&
-    operator=(this_type other) noexcept
+    operator=(this_type const& other)
     {
-        swap(*this, other);
+        if (this == &other) return *this;
+
+        this_type copy{ other, propagate_on_copy ? other.get_allocator() : get_allocator() };
+        replace_with<propagate_on_copy>(copy);
+        return *this;
+    }
+
+    ///! keeps own allocator, unless it propagates on move assignment.
+    ///! Then elements are moved one by one, if allocators are not equal
+    this_type&
+    operator=(this_type&& other) noexcept(propagate_on_move ||
+                                          allocator_traits::is_always_equal::value)
+    {
+        if (this == &other) return *this;
+
+        if constexpr (propagate_on_move)
+        {
+            this_type tmp{ std::move(other) };
+            replace_with<true>(tmp);
+        } else
+        {
+            this_type tmp{ std::move(other), get_allocator() };
+            replace_with<false>(tmp);
+        }
         return *this;
     }
 
@@ -118,12 +187,28 @@ public:
         return capacity() == size();
     }
 
+    ///! count of free slots, i.e. `capacity() - size()`.
+    ///! NOTE: unlike `std::vector::reserve` it doesn't allocate, see `reserve_capacity`
     size_type
     reserve() const noexcept
     {
         return capacity() - size();
     }
 
+    ///! grows storage to `sz` elements, like `std::vector::reserve`.
+    ///! Does nothing if `sz <= capacity()`
+    void
+    reserve_capacity(size_type sz)
+    {
+        if (sz > capacity()) relocate(sz);
+    }
+
+    void
+    shrink_to_fit()
+    {
+        if (size() != capacity()) relocate(size());
+    }
+
     void
     assign(std::ranges::input_range auto&& other)
     {
@@ -131,18 +216,19 @@ public:
         append_range(std::forward<decltype(other)>(other));
     }
 
+    ///! @pre allocators are equal, unless they propagate on swap
     friend void
-    swap(this_type& lhs, this_type& rhs) noexcept(noexcept(swap(lhs.m_allocator, rhs.m_allocator)))
+    swap(this_type& lhs, this_type& rhs) noexcept
     {
-        using std::swap;
-
-        swap(lhs.m_buf, rhs.m_buf);
-        swap(lhs.m_end, rhs.m_end);
-        swap(lhs.m_allocator, rhs.m_allocator);
-
-        swap(lhs.m_last, rhs.m_last);
-        swap(lhs.m_first, rhs.m_first);
-        swap(lhs.m_size, rhs.m_size);
+        if constexpr (propagate_on_swap)
+        {
+            using std::swap;
+            swap(lhs.m_allocator, rhs.m_allocator);
+        } else
+        {
+            assert(lhs.get_allocator() == rhs.get_allocator());
+        }
+        swap_storage(lhs, rhs);
     }
 
     void
@@ -160,21 +246,127 @@ public:
     void
     emplace_back(auto&&... args)
         requires std::is_constructible_v<value_type, decltype(args)...>
+    {
+        (void)try_emplace_back(std::forward<decltype(args)>(args)...);
+    }
+
+    bool
+    try_push(value_type const& v)
+    {
+        return try_emplace_back(v);
+    }
+
+    bool
+    try_push(value_type&& v)
+    {
+        return try_emplace_back(std::forward<value_type>(v));
+    }
+
+    ///! @return false if element was not inserted due to `overflow_policy`
+    bool
+    try_emplace_back(auto&&... args)
+        requires std::is_constructible_v<value_type, decltype(args)...>
     {
         if (full())
         {
-            if (empty()) return;
+            if constexpr (std::same_as<overflow_policy, overflow::grow>)
+            {
+                grow_emplace_back(std::forward<decltype(args)>(args)...);
+                return true;
+            } else if constexpr (std::same_as<overflow_policy, overflow::reject_newest>)
+            {
+                return false;
+            } else
+            {
+                if (empty()) return false;
+
+                if constexpr (std::is_move_assignable_v<value_type>)
+                {
+                    (*m_last) = value_type(std::forward<decltype(args)>(args)...);
+                    increment(m_last);
+                    m_first = m_last;
+                    return true;
+                } else
+                {
+                    // construct before the oldest is destroyed, because `args` can refer to it
+                    value_type v(std::forward<decltype(args)>(args)...);
+                    (void)discard_front(1);
+                    allocator_traits::construct(get_allocator(), m_last, std::move(v));
+                    increment(m_last);
+                    ++m_size;
+                    return true;
+                }
+            }
+        }
 
-            (*m_last) = value_type{ std::forward<decltype(args)>(args)... };
-            increment(m_last);
-            m_first = m_last;
-        } else
+        allocator_traits::construct(get_allocator(), m_last, std::forward<decltype(args)>(args)...);
+        increment(m_last);
+        ++m_size;
+        return true;
+    }
+
+    /*
+        Two-phase push and pop. Value is constructed and read right in the storage,
+        so there is no temporary, no `std::optional` and `T` can be even immovable
+        (if `overflow_policy` is not `grow`).
+        Interface is the same as of `lock_free_ringbuf`, so they are interchangeable.
+
+        ```
+            if (auto p{ buf.try_reserve_back() })
+            {
+                std::construct_at(std::to_address(p), args...);
+                buf.commit_back(p);
+            }
+        ```
+    */
+
+    ///! storage for the next element, when full acts according to `overflow_policy`.
+    ///! NOTE: with `overwrite_oldest` the oldest element is destroyed right here, not in
+    ///!       `commit_back`, because the next element takes its storage. There is no way to
+    ///!       cancel reservation, so reserve only when the element will be committed
+    ///! @return nullptr, if element can't be pushed
+    pointer
+    try_reserve_back()
+    {
+        if (full())
         {
-            allocator_traits::construct(get_allocator(), m_last,
-                                        std::forward<decltype(args)>(args)...);
-            increment(m_last);
-            ++m_size;
+            if constexpr (std::same_as<overflow_policy, overflow::grow>)
+            {
+                relocate(capacity() == 0 ? 1 : 2 * capacity());
+            } else if constexpr (std::same_as<overflow_policy, overflow::reject_newest>)
+            {
+                return nullptr;
+            } else
+            {
+                if (empty()) return nullptr;
+                (void)discard_front(1);
+            }
         }
+        return m_last;
+    }
+
+    ///! @pre `p` is returned by the last `try_reserve_back` and value is constructed in it
+    void
+    commit_back(pointer p) noexcept
+    {
+        assert(p == m_last && !full());
+        increment(m_last);
+        ++m_size;
+    }
+
+    ///! @return the oldest element, it stays in ringbuf until `release_front`, or nullptr if empty
+    pointer
+    try_peek_front() noexcept
+    {
+        return empty() ? nullptr : m_first;
+    }
+
+    ///! @pre `p` is returned by `try_peek_front`
+    void
+    release_front(pointer p) noexcept
+    {
+        assert(p == m_first && !empty());
+        (void)discard_front(1);
     }
 
     // TODO: specialize for `std::ranges::sized_range` using `drop(size(view) -
@@ -193,13 +385,45 @@ public:
         std::ranges::move(view, std::back_inserter(*this));
     }
 
+    ///! @pre !empty()
+    reference
+    front()
+    {
+        assert(!empty());
+        return *m_first;
+    }
+
+    ///! @pre !empty()
+    const_reference
+    front() const
+    {
+        assert(!empty());
+        return *m_first;
+    }
+
+    ///! @pre !empty()
+    reference
+    back()
+    {
+        assert(!empty());
+        return *std::prev(m_last == m_buf ? m_end : m_last);
+    }
+
+    ///! @pre !empty()
+    const_reference
+    back() const
+    {
+        assert(!empty());
+        return *std::prev(m_last == m_buf ? m_end : m_last);
+    }
+
     std::optional<value_type>
     pop_back()
     {
         if (empty()) return std::nullopt;
 
-        value_type ret{ *(--end()) };
         decrement(m_last);
+        value_type ret{ std::move(*m_last) };
         allocator_traits::destroy(get_allocator(), m_last);
         --m_size;
         return ret;
@@ -210,19 +434,70 @@ public:
     {
         if (empty()) return std::nullopt;
 
-        value_type ret{ *begin() };
+        value_type ret{ std::move(*m_first) };
         allocator_traits::destroy(get_allocator(), m_first);
         increment(m_first);
         --m_size;
         return ret;
     }
 
+    ///! moves the first element to `out`, so there is no temporaries
+    ///! @return false if ringbuf is empty and `out` is untouched
+    bool
+    pop_front_into(value_type& out)
+    {
+        if (empty()) return false;
+
+        out = std::move(*m_first);
+        allocator_traits::destroy(get_allocator(), m_first);
+        increment(m_first);
+        --m_size;
+        return true;
+    }
+
+    ///! removes up to `n` first elements, O(1) if they are trivially destructible
+    ///! @return count of removed elements
+    size_type
+    discard_front(size_type n)
+    {
+        n = std::min(n, size());
+
+        if constexpr (std::is_trivially_destructible_v<value_type>)
+        {
+            if (n != 0) m_first = add(m_first, n);
+        } else
+        {
+            for (size_type i{ 0 }; i < n; ++i)
+            {
+                allocator_traits::destroy(get_allocator(), m_first);
+                increment(m_first);
+            }
+        }
+        m_size -= n;
+        return n;
+    }
+
+    ///! calls `fn` for up to `n` first elements in place, then removes them
+    ///! @return count of removed elements
+    size_type
+    consume_front(size_type n, std::invocable<reference> auto&& fn)
+    {
+        n = std::min(n, size());
+
+        for (size_type i{ 0 }; i < n; ++i)
+        {
+            std::invoke(fn, *m_first);
+            allocator_traits::destroy(get_allocator(), m_first);
+            increment(m_first);
+            --m_size;
+        }
+        return n;
+    }
+
     void
     clear() noexcept
     {
-        using std::ranges::destroy_n;
-
-        std::destroy(begin(), end());
+        for_each_segment([this](pointer first, pointer end) { destroy(first, end); });
         m_first = m_buf;
         m_last = m_buf;
         m_size = 0;
@@ -276,6 +551,131 @@ public:
     }
 
 private:
+    // calls `fn(first, last)` for each contiguous part of [begin(), end()) in order
+    void
+    for_each_segment(auto&& fn)
+    {
+        if (empty()) return;
+
+        if (m_first < m_last)
+        {
+            fn(m_first, m_last);
+        } else
+        {
+            fn(m_first, m_end);
+            fn(m_buf, m_last);
+        }
+    }
+
+    void
+    destroy(pointer first, pointer last) noexcept
+    {
+        for (; first != last; ++first) allocator_traits::destroy(get_allocator(), first);
+    }
+
+    ///! @pre sz >= size()
+    void
+    relocate(size_type sz)
+    {
+        assert(sz >= size());
+        pointer const buf{ allocator_traits::allocate(get_allocator(), sz) };
+        try
+        {
+            relocate_to(buf, sz);
+        } catch (...)
+        {
+            allocator_traits::deallocate(get_allocator(), buf, sz);
+            throw;
+        }
+    }
+
+    // moves elements to the beginning of `buf`, so both parts become one,
+    // and makes `buf` the storage of ringbuf.
+    // Elements are copied, if move can throw, so if it throws, ringbuf is unchanged
+    // and `buf` is still owned by caller
+    void
+    relocate_to(pointer const buf, size_type const sz)
+    {
+        pointer last{ buf };
+        try
+        {
+            for_each_segment(
+                [&](pointer first, pointer end)
+                {
+                    for (; first != end; ++first, ++last)
+                        allocator_traits::construct(get_allocator(), last,
+                                                    std::move_if_noexcept(*first));
+                });
+        } catch (...)
+        {
+            destroy(buf, last);
+            throw;
+        }
+        for_each_segment([this](pointer first, pointer end) { destroy(first, end); });
+        allocator_traits::deallocate(get_allocator(), m_buf, capacity());
+
+        m_buf = buf;
+        m_end = buf + sz;
+        m_first = buf;
+        m_last = last == m_end ? m_buf : last;
+    }
+
+    static void
+    swap_storage(this_type& lhs, this_type& rhs) noexcept
+    {
+        using std::swap;
+
+        swap(lhs.m_buf, rhs.m_buf);
+        swap(lhs.m_end, rhs.m_end);
+
+        swap(lhs.m_last, rhs.m_last);
+        swap(lhs.m_first, rhs.m_first);
+        swap(lhs.m_size, rhs.m_size);
+    }
+
+    // `tmp` gets the old storage, so it must get allocator, which allocated it, too
+    template <bool PropagateAllocator>
+    void
+    replace_with(this_type& tmp) noexcept
+    {
+        swap_storage(*this, tmp);
+        if constexpr (PropagateAllocator)
+        {
+            using std::swap;
+            swap(m_allocator, tmp.m_allocator);
+        }
+    }
+
+    void
+    grow_emplace_back(auto&&... args)
+    {
+        size_type const sz{ capacity() == 0 ? 1 : 2 * capacity() };
+        pointer const buf{ allocator_traits::allocate(get_allocator(), sz) };
+
+        // construct new element first, because `args` can refer to element of this ringbuf
+        try
+        {
+            allocator_traits::construct(get_allocator(), buf + size(),
+                                        std::forward<decltype(args)>(args)...);
+        } catch (...)
+        {
+            allocator_traits::deallocate(get_allocator(), buf, sz);
+            throw;
+        }
+
+        try
+        {
+            relocate_to(buf, sz);
+        } catch (...)
+        {
+            allocator_traits::destroy(get_allocator(), buf + size());
+            allocator_traits::deallocate(get_allocator(), buf, sz);
+            throw;
+        }
+        increment(m_last);
+        ++m_size;
+    }
+
     void
     increment(pointer& p) const
     {
@@ -312,12 +712,12 @@ private:
     size_type m_size{ 0 };
 };
 
-template <std::semiregular T, typename Alloc>
+template <std::destructible T, typename Alloc, overflow::policy OverflowPolicy>
 template <bool IsConst>
-struct ringbuf<T, Alloc>::iterator
+struct ringbuf<T, Alloc, OverflowPolicy>::iterator
 {
 private:
-    using container_type = ringbuf<T, Alloc>;
+    using container_type = ringbuf<T, Alloc, OverflowPolicy>;
 
 public:
     using this_type = iterator;
@@ -473,4 +873,12 @@ static_assert(std::sentinel_for<ringbuf<int>::iterator<false>, ringbuf<int>::ite
 static_assert(std::sentinel_for<ringbuf<int>::iterator<true>, ringbuf<int>::iterator<true>>);
 static_assert(std::ranges::range<tt::ringbuf<int>&>);
 
+namespace pmr
+{
+
+template <std::destructible T, overflow::policy OverflowPolicy = overflow::overwrite_oldest>
+using ringbuf = tt::ringbuf<T, std::pmr::polymorphic_allocator<T>, OverflowPolicy>;
+
+} // namespace pmr
+
 } // namespace tt
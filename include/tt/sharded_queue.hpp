@@ -0,0 +1,199 @@
+#pragma once
+
+#include <tt/detail.hpp>
+#include <tt/lock_free_ringbuf.hpp>
+#include <tt/overflow.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace tt
+{
+
+namespace steal
+{
+
+/*
+    How consumer of `sharded_queue` chooses shard to pop from.
+*/
+
+///! own shard of thread first, then the others one by one
+struct round_robin
+{
+};
+
+///! the longer of two random shards, so load is balanced without scanning all of them.
+///! If both are empty, falls back to scan
+struct two_choices
+{
+};
+
+template <typename S>
+concept strategy = std::same_as<S, round_robin> || std::same_as<S, two_choices>;
+
+} // namespace steal
+
+/*
+    MPMC queue, which is a set of `lock_free_ringbuf` shards.
+
+    Each thread pushes to its own shard (chosen by `detail::thread_index()`), so producers
+    don't fight for one index, and throughput grows with count of shards.
+    Only when own shard is full, producer spills to the next ones.
+
+    The price is FIFO order: it's kept only inside one shard, i.e. for elements pushed
+    by one producer (until it spills), but not between producers.
+    See `sharded_queue_mpmc_*` vs `lock_free_ringbuf_mpmc` in bench-queue.
+
+    When all shards are full, new elements are rejected.
+*/
+template <std::destructible T, typename Alloc = std::allocator<T>,
+          steal::strategy StealStrategy = steal::round_robin>
+class sharded_queue
+{
+public:
+    using this_type = sharded_queue<T, Alloc, StealStrategy>;
+    using shard_type = lock_free_ringbuf<T, Alloc, overflow::reject_newest>;
+
+    using allocator_type = Alloc;
+    using steal_strategy = StealStrategy;
+    using value_type = shard_type::value_type;
+    using size_type = shard_type::size_type;
+
+private:
+    using shards_allocator =
+        std::allocator_traits<allocator_type>::template rebind_alloc<shard_type>;
+
+public:
+    ///! one shard per hardware thread
+    ///! @pre `shard_capacity` is power of 2
+    explicit sharded_queue(size_type shard_capacity, allocator_type const& alloc = allocator_type())
+        : sharded_queue(std::max(1u, std::thread::hardware_concurrency()), shard_capacity, alloc)
+    {
+    }
+
+    ///! @pre `shards_count` > 0 and `shard_capacity` is power of 2
+    sharded_queue(size_type shards_count, size_type shard_capacity,
+                  allocator_type const& alloc = allocator_type())
+        : m_shards(shards_allocator(alloc))
+    {
+        assert(shards_count > 0);
+        // shards are constructed in place and never moved
+        m_shards.reserve(shards_count);
+        for (size_type i{ 0 }; i < shards_count; ++i)
+        {
+            // polymorphic allocator passes itself to shard (uses-allocator construction)
+            if constexpr (std::same_as<allocator_type, std::pmr::polymorphic_allocator<T>>)
+                m_shards.emplace_back(shard_capacity);
+            else
+                m_shards.emplace_back(shard_capacity, alloc);
+        }
+    }
+
+    sharded_queue(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    size_type
+    shards_count() const noexcept
+    {
+        return m_shards.size();
+    }
+
+    ///! approximate, if other threads push or pop concurrently
+    size_type
+    size() const noexcept
+    {
+        return std::transform_reduce(m_shards.begin(), m_shards.end(), size_type{ 0 },
+                                     std::plus<>{}, [](auto const& s) { return s.size(); });
+    }
+
+    size_type
+    capacity() const noexcept
+    {
+        return shards_count() * m_shards.front().capacity();
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return 0 == size();
+    }
+
+    bool
+    try_push(value_type const& v)
+    {
+        return try_emplace_back(v);
+    }
+
+    bool
+    try_push(value_type&& v)
+    {
+        return try_emplace_back(std::forward<value_type>(v));
+    }
+
+    ///! @return false if all shards are full
+    bool
+    try_emplace_back(auto&&... args)
+        requires std::is_constructible_v<value_type, decltype(args)...>
+    {
+        size_type const home{ home_shard() };
+        for (size_type i{ 0 }; i < shards_count(); ++i)
+        {
+            // rejected push doesn't touch `args`, so it's safe to forward them again
+            if (m_shards[(home + i) % shards_count()].try_emplace_back(
+                    std::forward<decltype(args)>(args)...))
+                return true;
+        }
+        return false;
+    }
+
+    std::optional<value_type>
+    pop_front()
+        requires std::move_constructible<value_type>
+    {
+        size_type first{ home_shard() };
+
+        if constexpr (std::same_as<steal_strategy, steal::two_choices>)
+        {
+            if (shards_count() > 1)
+            {
+                size_type const a{ detail::thread_random() % shards_count() };
+                size_type b{ detail::thread_random() % (shards_count() - 1) };
+                if (b >= a) ++b;
+
+                first = m_shards[a].size() >= m_shards[b].size() ? a : b;
+            }
+        }
+
+        for (size_type i{ 0 }; i < shards_count(); ++i)
+        {
+            if (auto v{ m_shards[(first + i) % shards_count()].pop_front() }) return v;
+        }
+        return std::nullopt;
+    }
+
+private:
+    size_type
+    home_shard() const noexcept
+    {
+        return detail::thread_index() % shards_count();
+    }
+
+    std::vector<shard_type, shards_allocator> m_shards;
+};
+
+namespace pmr
+{
+
+template <std::destructible T, steal::strategy StealStrategy = steal::round_robin>
+using sharded_queue = tt::sharded_queue<T, std::pmr::polymorphic_allocator<T>, StealStrategy>;
+
+} // namespace pmr
+
+} // namespace tt
@@ -0,0 +1,596 @@
+#pragma once
+
+#include <tt/detail.hpp>
+#include <tt/wait.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace tt
+{
+
+/*
+    MPMC ringbuf for IPC, which lives in shared memory (`shm_open` or `memfd_create`).
+
+    It's the same Vyukov queue as `lock_free_ringbuf`, but region is mapped at different
+    addresses in different processes, so it contains no pointers: slots are found
+    by offset stored in header. Header is versioned, so process built with
+    other `T` or other version of layout can't attach to region by mistake.
+
+    Push and pop are one copy of `T` and a few atomics, no syscalls. Blocking calls park
+    in process-shared futex (std::atomic::wait uses private one on linux, so it can't
+    wake other process) and are notified only if somebody is actually parked.
+
+    When full, new elements are rejected, since the oldest one can be read by other process.
+
+    If process dies between reservation and publishing of slot, it stays busy forever,
+    and the whole queue stalls on it. Recovery is up to user, e.g. recreate region.
+*/
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+class shm_ringbuf
+{
+public:
+    using this_type = shm_ringbuf<T>;
+    using value_type = T;
+    using size_type = std::uint64_t;
+
+    static_assert(std::atomic<size_type>::is_always_lock_free,
+                  "atomics in shared memory must be address-free, i.e. lock-free");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+    struct header
+    {
+        // written the last by creator, so region is ready, when magic is seen
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t value_size;
+        std::uint32_t value_align;
+        std::uint32_t slot_size;
+        size_type capacity;
+        // from the beginning of region
+        size_type slots_offset;
+
+        // producers write `last`, consumers write `first`, so they live in different cache lines
+        alignas(detail::cache_line_size) std::atomic<size_type> last;
+        alignas(detail::cache_line_size) std::atomic<size_type> first;
+
+        // futex words, see `park_producer`
+        alignas(detail::cache_line_size) std::atomic<std::uint32_t> parked_producers;
+        std::atomic<std::uint32_t> parked_consumers;
+        std::atomic<std::uint32_t> push_epoch;
+        std::atomic<std::uint32_t> pop_epoch;
+    };
+
+    // "ttshmrb" in little endian
+    static constexpr std::uint64_t magic{ 0x0062726d68737474 };
+    static constexpr std::uint32_t version{ 1 };
+
+    ///! how long to wait for other process, which is creating the same region
+    static constexpr std::chrono::seconds init_timeout{ 1 };
+
+private:
+    struct alignas(detail::cache_line_size) slot_type
+    {
+        std::atomic<size_type> seq;
+        value_type value;
+    };
+
+public:
+    ///! opens region or creates new one, if it's absent
+    ///! @throws std::system_error if region can't be opened or mapped
+    ///! @throws std::runtime_error if region exists, but was created for other `T` or capacity
+    ///! @pre `name` is valid for `shm_open` and `capacity` is power of 2
+    shm_ringbuf(std::string const& name, size_type capacity)
+    {
+        assert(detail::is_power_of_2(capacity));
+        guarded([&] { open_or_create(name, capacity); });
+    }
+
+    ///! opens existing region, capacity is read from it
+    explicit shm_ringbuf(std::string const& name)
+    {
+        guarded([&] { open_existing(name); });
+    }
+
+    ///! creates region, which has no name, share it by `fork` or by passing `fd()` to
+    ///! other process over unix socket
+    ///! @pre `capacity` is power of 2
+    static this_type
+    anonymous(size_type capacity)
+    {
+        assert(detail::is_power_of_2(capacity));
+
+        this_type ret;
+        ret.guarded(
+            [&]
+            {
+                ret.m_fd = ::memfd_create("tt-shm-ringbuf", MFD_CLOEXEC);
+                if (-1 == ret.m_fd) fail("shm_ringbuf: memfd_create");
+                ret.create(capacity);
+            });
+        return ret;
+    }
+
+    ///! attaches to region, created by `anonymous` or by name, and takes ownership of `fd`
+    static this_type
+    from_fd(int fd)
+    {
+        this_type ret;
+        ret.m_fd = fd;
+        ret.guarded([&] { ret.attach(std::nullopt); });
+        return ret;
+    }
+
+    ///! removes name of region, it's destroyed, when the last process unmaps it
+    static void
+    unlink(std::string const& name) noexcept
+    {
+        ::shm_unlink(name.c_str());
+    }
+
+    shm_ringbuf(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    shm_ringbuf(this_type&& other) noexcept
+        : m_fd{ std::exchange(other.m_fd, -1) }
+        , m_map{ std::exchange(other.m_map, nullptr) }
+        , m_map_size{ std::exchange(other.m_map_size, 0) }
+        , m_header{ std::exchange(other.m_header, nullptr) }
+        , m_slots{ std::exchange(other.m_slots, nullptr) }
+    {
+    }
+
+    this_type&
+    operator=(this_type&& other) noexcept
+    {
+        this_type tmp{ std::move(other) };
+        swap(*this, tmp);
+        return *this;
+    }
+
+    ~shm_ringbuf()
+    {
+        close();
+    }
+
+    friend void
+    swap(this_type& lhs, this_type& rhs) noexcept
+    {
+        using std::swap;
+
+        swap(lhs.m_fd, rhs.m_fd);
+        swap(lhs.m_map, rhs.m_map);
+        swap(lhs.m_map_size, rhs.m_map_size);
+        swap(lhs.m_header, rhs.m_header);
+        swap(lhs.m_slots, rhs.m_slots);
+    }
+
+    ///! descriptor of region, it's closed by dtor
+    int
+    fd() const noexcept
+    {
+        return m_fd;
+    }
+
+    ///! approximate, if other threads push or pop concurrently
+    size_type
+    size() const noexcept
+    {
+        size_type const first{ m_header->first.load(std::memory_order::relaxed) };
+        size_type const last{ m_header->last.load(std::memory_order::relaxed) };
+
+        std::int64_t const diff{ static_cast<std::int64_t>(last - first) };
+        return static_cast<size_type>(
+            std::clamp<std::int64_t>(diff, 0, static_cast<std::int64_t>(capacity())));
+    }
+
+    size_type
+    capacity() const noexcept
+    {
+        return m_header->capacity;
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return 0 == size();
+    }
+
+    bool
+    full() const noexcept
+    {
+        return capacity() == size();
+    }
+
+    ///! @return false if full
+    bool
+    try_push(value_type const& v) noexcept
+    {
+        size_type pos{ m_header->last.load(std::memory_order::relaxed) };
+        for (;;)
+        {
+            std::int64_t const diff{ seq_diff(pos, empty_seq) };
+            if (diff < 0) return false;
+
+            // seq_cst is for parked consumers, see `park_consumer`
+            if (diff == 0 && m_header->last.compare_exchange_weak(
+                                 pos, pos + 1, std::memory_order::seq_cst,
+                                 std::memory_order::relaxed))
+                break;
+            if (diff > 0) pos = m_header->last.load(std::memory_order::relaxed);
+        }
+
+        slot_type& s{ slot_at(pos) };
+        s.value = v;
+        s.seq.store(full_seq(pos), std::memory_order::release);
+        notify(m_header->parked_consumers, m_header->push_epoch);
+        return true;
+    }
+
+    std::optional<value_type>
+    pop_front() noexcept
+    {
+        size_type pos{ m_header->first.load(std::memory_order::relaxed) };
+        for (;;)
+        {
+            std::int64_t const diff{ seq_diff(pos, full_seq) };
+            if (diff < 0) return std::nullopt;
+
+            // seq_cst is for parked producers, see `park_producer`
+            if (diff == 0 && m_header->first.compare_exchange_weak(
+                                 pos, pos + 1, std::memory_order::seq_cst,
+                                 std::memory_order::relaxed))
+                break;
+            if (diff > 0) pos = m_header->first.load(std::memory_order::relaxed);
+        }
+
+        slot_type& s{ slot_at(pos) };
+        value_type const ret{ s.value };
+        s.seq.store(empty_seq(pos + capacity()), std::memory_order::release);
+        notify(m_header->parked_producers, m_header->pop_epoch);
+        return ret;
+    }
+
+    ///! waits for free slot, see `lock_free_ringbuf::push_wait`
+    template <wait::strategy Strategy = wait::spin_park>
+    void
+    push_wait(value_type const& v) noexcept
+    {
+        wait::backoff<Strategy> backoff;
+        while (!try_push(v))
+        {
+            if (backoff()) park_producer(nullptr);
+        }
+    }
+
+    ///! waits for element, see `lock_free_ringbuf::pop_wait`
+    template <wait::strategy Strategy = wait::spin_park>
+    value_type
+    pop_wait() noexcept
+    {
+        wait::backoff<Strategy> backoff;
+        for (;;)
+        {
+            if (auto v{ pop_front() }) return *v;
+            if (backoff()) park_consumer(nullptr);
+        }
+    }
+
+    ///! unlike `lock_free_ringbuf`, parks with timeout, since futex supports it
+    ///! @return false, if timeout is reached
+    template <typename Rep, typename Period>
+    bool
+    push_wait_for(value_type const& v, std::chrono::duration<Rep, Period> timeout) noexcept
+    {
+        auto const deadline{ std::chrono::steady_clock::now() + timeout };
+        wait::backoff<wait::spin_park> backoff;
+        while (!try_push(v))
+        {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            if (backoff()) park_producer(&deadline);
+        }
+        return true;
+    }
+
+    template <typename Rep, typename Period>
+    std::optional<value_type>
+    pop_wait_for(std::chrono::duration<Rep, Period> timeout) noexcept
+    {
+        auto const deadline{ std::chrono::steady_clock::now() + timeout };
+        wait::backoff<wait::spin_park> backoff;
+        for (;;)
+        {
+            if (auto v{ pop_front() }) return v;
+            if (std::chrono::steady_clock::now() >= deadline) return std::nullopt;
+            if (backoff()) park_consumer(&deadline);
+        }
+    }
+
+private:
+    shm_ringbuf() = default;
+
+    [[noreturn]] static void
+    fail(char const* what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    // dtor is not called if ctor throws, so close everything opened so far
+    void
+    guarded(auto&& open)
+    {
+        try
+        {
+            open();
+        } catch (...)
+        {
+            close();
+            throw;
+        }
+    }
+
+    void
+    close() noexcept
+    {
+        if (nullptr != m_map) ::munmap(m_map, m_map_size);
+        if (-1 != m_fd) ::close(m_fd);
+        m_map = nullptr;
+        m_fd = -1;
+    }
+
+    void
+    open_or_create(std::string const& name, size_type capacity)
+    {
+        // O_EXCL decides, who of racing processes initializes region
+        m_fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (-1 != m_fd)
+        {
+            create(capacity);
+            return;
+        }
+        if (EEXIST != errno) fail("shm_ringbuf: shm_open");
+
+        m_fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (-1 == m_fd) fail("shm_ringbuf: shm_open");
+        attach(capacity);
+    }
+
+    void
+    open_existing(std::string const& name)
+    {
+        m_fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (-1 == m_fd) fail("shm_ringbuf: shm_open");
+        attach(std::nullopt);
+    }
+
+    void
+    create(size_type capacity)
+    {
+        m_map_size = region_size(capacity);
+        if (0 != ::ftruncate(m_fd, static_cast<off_t>(m_map_size))) fail("shm_ringbuf: ftruncate");
+        map();
+
+        // fresh region is zeroed, so only non-zero fields are written
+        m_header = std::construct_at(static_cast<header*>(m_map));
+        m_header->version = version;
+        m_header->value_size = sizeof(value_type);
+        m_header->value_align = alignof(value_type);
+        m_header->slot_size = sizeof(slot_type);
+        m_header->capacity = capacity;
+        m_header->slots_offset = slots_offset;
+
+        m_slots = slots_of(m_map);
+        for (size_type i{ 0 }; i < capacity; ++i)
+        {
+            std::construct_at(m_slots + i);
+            m_slots[i].seq.store(empty_seq(i), std::memory_order::relaxed);
+        }
+
+        // publishes all above to processes, which wait in `attach`
+        std::atomic_ref<std::uint64_t>{ m_header->magic }.store(magic, std::memory_order::release);
+    }
+
+    void
+    attach(std::optional<size_type> capacity)
+    {
+        // creator could still be between `shm_open` and `ftruncate`
+        wait::timed_backoff backoff{ std::chrono::steady_clock::now() + init_timeout };
+        struct stat st;
+        for (;;)
+        {
+            if (0 != ::fstat(m_fd, &st)) fail("shm_ringbuf: fstat");
+            if (static_cast<std::size_t>(st.st_size) >= sizeof(header)) break;
+            if (!backoff()) throw std::runtime_error("shm_ringbuf: region is not initialized");
+        }
+
+        m_map_size = static_cast<std::size_t>(st.st_size);
+        map();
+        m_header = static_cast<header*>(m_map);
+
+        // ... or between `ftruncate` and publishing of magic
+        std::atomic_ref<std::uint64_t> const published{ m_header->magic };
+        while (0 == published.load(std::memory_order::acquire))
+        {
+            if (!backoff()) throw std::runtime_error("shm_ringbuf: region is not initialized");
+        }
+
+        bool const compatible{
+            published.load(std::memory_order::relaxed) == magic && m_header->version == version &&
+            m_header->value_size == sizeof(value_type) &&
+            m_header->value_align == alignof(value_type) &&
+            m_header->slot_size == sizeof(slot_type) && m_header->slots_offset == slots_offset &&
+            detail::is_power_of_2(m_header->capacity) &&
+            m_map_size == region_size(m_header->capacity) &&
+            (!capacity || *capacity == m_header->capacity)
+        };
+        if (!compatible) throw std::runtime_error("shm_ringbuf: incompatible region");
+
+        m_slots = slots_of(m_map);
+    }
+
+    void
+    map()
+    {
+        m_map = ::mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (MAP_FAILED == m_map)
+        {
+            m_map = nullptr;
+            fail("shm_ringbuf: mmap");
+        }
+    }
+
+    /*
+        Parking is the same Dekker-like handshake, as in `lock_free_ringbuf`:
+
+            waiter:   ++parked; load index;     notifier:   CAS index; load parked
+
+        but waiter sleeps in futex, shared between processes.
+    */
+
+    void
+    park_producer(std::chrono::steady_clock::time_point const* deadline) noexcept
+    {
+        std::uint32_t const epoch{ m_header->pop_epoch.load(std::memory_order::acquire) };
+        m_header->parked_producers.fetch_add(1, std::memory_order::seq_cst);
+
+        size_type const first{ m_header->first.load(std::memory_order::seq_cst) };
+        size_type const last{ m_header->last.load(std::memory_order::relaxed) };
+        if (last - first >= capacity()) futex_wait(m_header->pop_epoch, epoch, deadline);
+
+        m_header->parked_producers.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    void
+    park_consumer(std::chrono::steady_clock::time_point const* deadline) noexcept
+    {
+        std::uint32_t const epoch{ m_header->push_epoch.load(std::memory_order::acquire) };
+        m_header->parked_consumers.fetch_add(1, std::memory_order::seq_cst);
+
+        size_type const last{ m_header->last.load(std::memory_order::seq_cst) };
+        size_type const first{ m_header->first.load(std::memory_order::relaxed) };
+        if (static_cast<std::int64_t>(last - first) <= 0)
+            futex_wait(m_header->push_epoch, epoch, deadline);
+
+        m_header->parked_consumers.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    static void
+    notify(std::atomic<std::uint32_t>& parked, std::atomic<std::uint32_t>& epoch) noexcept
+    {
+        // the only cost of parking for fast path
+        if (0 == parked.load(std::memory_order::seq_cst)) return;
+
+        epoch.fetch_add(1, std::memory_order::release);
+        futex_wake(epoch, 1);
+    }
+
+    // not `std::atomic::wait`, since it uses process private futex
+    static void
+    futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected,
+               std::chrono::steady_clock::time_point const* deadline) noexcept
+    {
+        timespec timeout{};
+        if (deadline != nullptr)
+        {
+            auto const left{ std::max(*deadline - std::chrono::steady_clock::now(),
+                                      std::chrono::steady_clock::duration::zero()) };
+            auto const sec{ std::chrono::duration_cast<std::chrono::seconds>(left) };
+            timeout.tv_sec = static_cast<time_t>(sec.count());
+            timeout.tv_nsec = static_cast<long>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(left - sec).count());
+        }
+
+        // spurious wakeups and EAGAIN are fine, caller checks the condition again
+        ::syscall(SYS_futex, futex_word(word), FUTEX_WAIT, expected,
+                  deadline != nullptr ? &timeout : nullptr, nullptr, 0);
+    }
+
+    static void
+    futex_wake(std::atomic<std::uint32_t>& word, int count) noexcept
+    {
+        ::syscall(SYS_futex, futex_word(word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+    }
+
+    static std::uint32_t*
+    futex_word(std::atomic<std::uint32_t>& word) noexcept
+    {
+        static_assert(sizeof(word) == sizeof(std::uint32_t));
+        return reinterpret_cast<std::uint32_t*>(&word);
+    }
+
+    static constexpr std::size_t slots_offset{
+        detail::divceil(sizeof(header), alignof(slot_type)) * alignof(slot_type)
+    };
+
+    static std::size_t
+    region_size(size_type capacity)
+    {
+        return slots_offset + capacity * sizeof(slot_type);
+    }
+
+    static slot_type*
+    slots_of(void* map) noexcept
+    {
+        return reinterpret_cast<slot_type*>(static_cast<std::byte*>(map) + slots_offset);
+    }
+
+    // see `lock_free_ringbuf::empty_seq`
+    static constexpr size_type
+    empty_seq(size_type pos)
+    {
+        return 2 * pos;
+    }
+
+    static constexpr size_type
+    full_seq(size_type pos)
+    {
+        return 2 * pos + 1;
+    }
+
+    slot_type&
+    slot_at(size_type pos) const noexcept
+    {
+        return m_slots[pos & (capacity() - 1)];
+    }
+
+    // zero - slot is ready for `pos`, negative - it's still busy with previous round,
+    // positive - `pos` is stale
+    std::int64_t
+    seq_diff(size_type pos, size_type (*state)(size_type)) const noexcept
+    {
+        // acquire pairs with release of the previous owner of slot
+        size_type const seq{ slot_at(pos).seq.load(std::memory_order::acquire) };
+        return static_cast<std::int64_t>(seq - state(pos));
+    }
+
+    int m_fd{ -1 };
+    void* m_map{ nullptr };
+    std::size_t m_map_size{ 0 };
+
+    // point into mapping, so they are valid only in this process
+    header* m_header{ nullptr };
+    slot_type* m_slots{ nullptr };
+};
+
+} // namespace tt
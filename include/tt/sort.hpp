@@ -4,11 +4,16 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <memory_resource>
 #include <ranges>
+#include <type_traits>
+#include <vector>
 
 namespace tt
 {
@@ -32,6 +37,165 @@ namespace tt
     The most interesting awaits you in the end - benchmarks
 */
 
+/*
+    Where time of sort goes.
+
+    Profiler is passed to `radix_sort` as the last argument and gets time and bytes
+    of each phase of each pass. By default it's `no_sort_profiler`,
+    then clock is never read and sort is compiled exactly as without profiling.
+*/
+enum class sort_phase : std::uint8_t
+{
+    // count keys
+    histogram,
+    // turn counts into positions
+    prefix_sum,
+    // move elements to their positions
+    scatter,
+    // move elements back to input range before the next pass, and to output after the last one
+    copy_back,
+};
+
+inline constexpr std::size_t sort_phases_count{
+    static_cast<std::size_t>(sort_phase::copy_back) + 1
+};
+
+///! profiling is disabled
+struct no_sort_profiler
+{
+};
+
+///! `bytes` is size of data, which phase read or wrote, i.e. elements or counts
+template <typename P>
+concept sort_profiler =
+    std::same_as<P, no_sort_profiler> ||
+    requires(P& p, std::size_t pass, sort_phase phase, std::chrono::nanoseconds time,
+             std::size_t bytes) { p.record(pass, phase, time, bytes); };
+
+///! sums time and bytes of each phase of each pass over all profiled sorts
+struct sort_phase_timings
+{
+    struct entry
+    {
+        std::chrono::nanoseconds time{ 0 };
+        std::size_t bytes{ 0 };
+    };
+
+    // indexed by pass, then by phase
+    std::vector<std::array<entry, sort_phases_count>> passes;
+
+    void
+    record(std::size_t pass, sort_phase phase, std::chrono::nanoseconds time, std::size_t bytes)
+    {
+        if (passes.size() <= pass) passes.resize(pass + 1);
+        entry& e{ passes[pass][static_cast<std::size_t>(phase)] };
+        e.time += time;
+        e.bytes += bytes;
+    }
+
+    ///! sum of phase over all passes
+    entry
+    total(sort_phase phase) const noexcept
+    {
+        entry r;
+        for (auto const& pass : passes)
+        {
+            r.time += pass[static_cast<std::size_t>(phase)].time;
+            r.bytes += pass[static_cast<std::size_t>(phase)].bytes;
+        }
+        return r;
+    }
+
+    ///! sum of all phases of pass
+    std::chrono::nanoseconds
+    total(std::size_t pass) const noexcept
+    {
+        std::chrono::nanoseconds r{ 0 };
+        for (entry const& e : passes[pass]) r += e.time;
+        return r;
+    }
+
+    void
+    clear() noexcept
+    {
+        passes.clear();
+    }
+};
+
+namespace detail
+{
+
+// measures time since previous lap
+template <typename Profiler>
+class phase_timer
+{
+public:
+    phase_timer(Profiler& profiler, std::size_t pass)
+        : m_profiler{ profiler }
+        , m_pass{ pass }
+        , m_start{ std::chrono::steady_clock::now() }
+    {
+    }
+
+    void
+    lap(sort_phase phase, std::size_t bytes)
+    {
+        auto const now{ std::chrono::steady_clock::now() };
+        m_profiler.record(m_pass, phase, now - m_start, bytes);
+        m_start = now;
+    }
+
+private:
+    Profiler& m_profiler;
+    std::size_t m_pass;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+template <>
+class phase_timer<no_sort_profiler>
+{
+public:
+    constexpr phase_timer(no_sort_profiler&, std::size_t) noexcept
+    {
+    }
+
+    constexpr void
+    lap(sort_phase, std::size_t) noexcept
+    {
+    }
+};
+
+template <typename Rng, typename Out, typename Count, typename KeyFn, typename Proj,
+          typename Timer>
+constexpr void
+counting_sort_phases(Rng&& r, Out out, Count& count, KeyFn& key_fn, Proj& proj, Timer& timer)
+{
+    namespace vs = std::views;
+    using value_type = std::ranges::range_value_t<Rng>;
+
+    // range may be not sized, so count it here. Unused without profiler
+    std::size_t n{ 0 };
+    for (auto const& i : r | vs::transform(proj) | vs::transform(key_fn))
+    {
+        count[i] += 1;
+        ++n;
+    }
+    timer.lap(sort_phase::histogram, n * sizeof(value_type));
+
+    for (auto [l, r] : count | vs::pairwise) r += l;
+    timer.lap(sort_phase::prefix_sum, count.size() * sizeof(typename Count::value_type));
+
+    for (auto&& el : r | vs::reverse)
+    {
+        auto& i{ count[std::invoke(key_fn, std::invoke(proj, el))] };
+        --i;
+        out[i] = std::forward<decltype(el)>(el);
+    }
+    timer.lap(sort_phase::scatter, n * sizeof(value_type));
+}
+
+} // namespace detail
+
 /*
     Counting sort
 
@@ -55,21 +219,13 @@ constexpr void
 counting_sort(Rng&& r, Out out, KeyType max, KeyFn key_fn = {}, Proj proj = {},
               Alloc<std::size_t> const& alloc = {})
 {
-    namespace vs = std::views;
     using allocator_type = Alloc<std::size_t>;
 
     std::vector<std::size_t, allocator_type> count{ static_cast<std::size_t>(max) + 1, 0uz, alloc };
 
-    for (auto const& i : r | vs::transform(proj) | vs::transform(key_fn)) count[i] += 1;
-
-    for (auto [l, r] : count | vs::pairwise) r += l;
-
-    for (auto&& el : r | vs::reverse)
-    {
-        auto& i{ count[std::invoke(key_fn, std::invoke(proj, el))] };
-        --i;
-        out[i] = std::forward<decltype(el)>(el);
-    }
+    no_sort_profiler profiler;
+    detail::phase_timer timer{ profiler, 0 };
+    detail::counting_sort_phases(std::forward<Rng>(r), std::move(out), count, key_fn, proj, timer);
 }
 
 template <typename Rng, typename Out, typename KeyFn = std::identity, typename Proj = std::identity,
@@ -141,7 +297,8 @@ struct byte_radix_traits
 static_assert(radix_traits<byte_radix_traits<std::size_t>>);
 
 template <typename Rng, typename Out, typename KeyFn = std::identity, typename Proj = std::identity,
-          radix_traits Traits = byte_radix_traits<detail::compose_result_t<KeyFn, Proj, std::ranges::range_value_t<Rng>>>>
+          radix_traits Traits = byte_radix_traits<detail::compose_result_t<KeyFn, Proj, std::ranges::range_value_t<Rng>>>,
+          typename Profiler = no_sort_profiler>
 
     requires requires(KeyFn key_fn, Proj proj, Traits traits, std::ranges::range_value_t<Rng> v, std::size_t cur) {
         {
@@ -150,12 +307,15 @@ template <typename Rng, typename Out, typename KeyFn = std::identity, typename P
 
         requires std::indirectly_writable<Out, std::ranges::range_value_t<Rng>>;
         requires std::indirectly_swappable<std::ranges::iterator_t<Rng>, Out>;
+        requires sort_profiler<std::remove_cvref_t<Profiler>>;
     }
 constexpr void
-radix_sort(Rng&& r, Out out, KeyFn key_fn = {}, Proj proj = {}, Traits traits = {})
+radix_sort(Rng&& r, Out out, KeyFn key_fn = {}, Proj proj = {}, Traits traits = {},
+           Profiler&& profiler = {})
 {
     namespace rng = std::ranges;
     using radix_type = typename Traits::radix_type;
+    using value_type = rng::range_value_t<Rng>;
 
     constexpr auto max{ std::numeric_limits<radix_type>::max() };
     constexpr auto buf_size{ static_cast<std::size_t>(max) + 1 };
@@ -168,17 +328,26 @@ radix_sort(Rng&& r, Out out, KeyFn key_fn = {}, Proj proj = {}, Traits traits =
     using allocator_type = std::pmr::polymorphic_allocator<buf_value_type>;
     allocator_type alloc{ &resource };
 
+    std::vector<buf_value_type, allocator_type> count(buf_size, alloc);
+
+    std::size_t const bytes{ static_cast<std::size_t>(rng::size(r)) * sizeof(value_type) };
+    std::size_t pass{ 0 };
     for (auto const cur_radix : traits.radices())
     {
-        counting_sort(
-            r, out, max,
-            [&key_fn, cur_radix, &traits](auto const& el)
-            { return traits.nth_radix_proj(cur_radix)(std::invoke(key_fn, el)); },
-            proj, alloc);
+        detail::phase_timer timer{ profiler, pass++ };
+
+        rng::fill(count, 0);
+        auto const radix_fn = [&key_fn, cur_radix, &traits](auto const& el)
+        { return traits.nth_radix_proj(cur_radix)(std::invoke(key_fn, el)); };
+        detail::counting_sort_phases(r, out, count, radix_fn, proj, timer);
 
         rng::move(out, rng::next(out, rng::size(r)), rng::begin(r));
-        resource.release();
+        timer.lap(sort_phase::copy_back, bytes);
     }
+
+    // counted as copy back of the last pass
+    detail::phase_timer timer{ profiler, pass == 0 ? 0 : pass - 1 };
     rng::move(r, out);
+    timer.lap(sort_phase::copy_back, bytes);
 }
 } // namespace tt
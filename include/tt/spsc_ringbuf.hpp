@@ -0,0 +1,242 @@
+#pragma once
+
+#include <tt/detail.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+
+namespace tt
+{
+
+/*
+    Wait-free ring buffer for exactly one producer and one consumer thread.
+
+    There is no CAS loops and no per-slot sequences, like in `lock_free_ringbuf`,
+    because each index has only one writer. So push/pop is plain load/store of indices.
+
+    Each side also caches index of the other side and reloads it only when
+    buffer looks full (for producer) or empty (for consumer),
+    so in steady state they don't touch cache line of each other at all.
+
+    When full, new elements are rejected.
+*/
+template <typename T, typename Alloc = std::allocator<T>>
+class spsc_ringbuf
+{
+public:
+    using this_type = spsc_ringbuf<T, Alloc>;
+
+    using allocator_type = Alloc;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using value_type = allocator_traits::value_type;
+    using pointer = allocator_traits::pointer;
+    using size_type = allocator_traits::size_type;
+
+    ///! @pre `sz` is power of 2
+    spsc_ringbuf(size_type sz, allocator_type const& alloc = allocator_type())
+        : m_allocator(alloc)
+    {
+        assert(detail::is_power_of_2(sz));
+        m_buf = allocator_traits::allocate(m_allocator, sz);
+        m_capacity = sz;
+    }
+
+    spsc_ringbuf(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    ~spsc_ringbuf()
+    {
+        while (pop_front()) {}
+        allocator_traits::deallocate(m_allocator, m_buf, capacity());
+    }
+
+    allocator_type
+    get_allocator() const noexcept
+    {
+        return m_allocator;
+    }
+
+    ///! exact only if called from producer or consumer thread, otherwise approximate
+    size_type
+    size() const noexcept
+    {
+        size_type const first{ m_first.load(std::memory_order::acquire) };
+        return m_last.load(std::memory_order::acquire) - first;
+    }
+
+    size_type
+    capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return 0 == size();
+    }
+
+    bool
+    full() const noexcept
+    {
+        return capacity() == size();
+    }
+
+    // producer side
+
+    bool
+    try_push(value_type const& v)
+    {
+        return try_emplace_back(v);
+    }
+
+    bool
+    try_push(value_type&& v)
+    {
+        return try_emplace_back(std::forward<value_type>(v));
+    }
+
+    ///! @return false if buffer is full
+    bool
+    try_emplace_back(auto&&... args)
+        requires std::is_constructible_v<value_type, decltype(args)...>
+    {
+        size_type const last{ m_last.load(std::memory_order::relaxed) };
+        if (last - m_first_cached == capacity())
+        {
+            m_first_cached = m_first.load(std::memory_order::acquire);
+            if (last - m_first_cached == capacity()) return false;
+        }
+
+        allocator_traits::construct(m_allocator, slot(last),
+                                    std::forward<decltype(args)>(args)...);
+        m_last.store(last + 1, std::memory_order::release);
+        return true;
+    }
+
+    ///! copies as many elements from the beginning of `values` as fits.
+    ///! If copy throws, elements copied before it are pushed, as if `values` ended there
+    ///! @return count of pushed elements
+    size_type
+    push_n(std::span<value_type const> values)
+    {
+        size_type const last{ m_last.load(std::memory_order::relaxed) };
+        if (capacity() - (last - m_first_cached) < values.size())
+            m_first_cached = m_first.load(std::memory_order::acquire);
+
+        size_type const n{ std::min(capacity() - (last - m_first_cached), values.size()) };
+        size_type constructed{ 0 };
+        try
+        {
+            for_each_segment(last, n,
+                             [&, it = values.begin()](pointer p, size_type count) mutable
+                             {
+                                 for (size_type i{ 0 }; i < count; ++i, ++constructed)
+                                     allocator_traits::construct(m_allocator, p + i, *it++);
+                             });
+        } catch (...)
+        {
+            m_last.store(last + constructed, std::memory_order::release);
+            throw;
+        }
+        m_last.store(last + n, std::memory_order::release);
+        return n;
+    }
+
+    // consumer side
+
+    std::optional<value_type>
+    pop_front()
+    {
+        size_type const first{ m_first.load(std::memory_order::relaxed) };
+        if (first == m_last_cached)
+        {
+            m_last_cached = m_last.load(std::memory_order::acquire);
+            if (first == m_last_cached) return std::nullopt;
+        }
+
+        value_type ret{ std::move(*slot(first)) };
+        allocator_traits::destroy(m_allocator, slot(first));
+        m_first.store(first + 1, std::memory_order::release);
+        return ret;
+    }
+
+    ///! moves as many elements as available to the beginning of `out`
+    ///! @return count of popped elements
+    size_type
+    pop_n(std::span<value_type> out)
+    {
+        size_type const first{ m_first.load(std::memory_order::relaxed) };
+        if (m_last_cached - first < out.size())
+            m_last_cached = m_last.load(std::memory_order::acquire);
+
+        size_type const n{ std::min(m_last_cached - first, out.size()) };
+        for_each_segment(first, n,
+                         [&, it = out.begin()](pointer p, size_type count) mutable
+                         {
+                             for (size_type i{ 0 }; i < count; ++i)
+                             {
+                                 *it++ = std::move(p[i]);
+                                 allocator_traits::destroy(m_allocator, p + i);
+                             }
+                         });
+        m_first.store(first + n, std::memory_order::release);
+        return n;
+    }
+
+private:
+    ///! @pre capacity() > 0
+    size_type
+    mask() const
+    {
+        assert(capacity() > 0);
+        return capacity() - 1;
+    }
+
+    pointer
+    slot(size_type pos) const
+    {
+        return m_buf + (pos & mask());
+    }
+
+    // calls `fn(first, count)` for each contiguous part of `n` slots starting from `pos`
+    void
+    for_each_segment(size_type pos, size_type n, auto&& fn)
+    {
+        if (n == 0) return;
+
+        size_type const head{ std::min(n, capacity() - (pos & mask())) };
+        fn(slot(pos), head);
+        if (head != n) fn(m_buf, n - head);
+    }
+
+    pointer m_buf{ nullptr };
+    size_type m_capacity{ 1 };
+    [[no_unique_address]] allocator_type m_allocator;
+
+    // written by producer, it also owns cached copy of `m_first`
+    alignas(detail::cache_line_size) std::atomic<size_type> m_last{ 0 };
+    size_type m_first_cached{ 0 };
+
+    // written by consumer, it also owns cached copy of `m_last`
+    alignas(detail::cache_line_size) std::atomic<size_type> m_first{ 0 };
+    size_type m_last_cached{ 0 };
+
+    static_assert(decltype(m_last)::is_always_lock_free);
+    static_assert(decltype(m_first)::is_always_lock_free);
+};
+
+namespace pmr
+{
+
+template <typename T>
+using spsc_ringbuf = tt::spsc_ringbuf<T, std::pmr::polymorphic_allocator<T>>;
+
+} // namespace pmr
+
+} // namespace tt
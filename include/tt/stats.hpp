@@ -0,0 +1,262 @@
+#pragma once
+
+#include <tt/detail.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace tt::stats
+{
+
+/*
+    What a concurrent queue counts about itself, to see why it stalls.
+
+    Policy is a tag type passed as template parameter, like `overflow::policy`.
+    With `none` counters don't exist at all and all counting calls are empty inline functions.
+    With `counting` each thread counts in its own shard (cache line), so counters don't add
+    contention, and they are summed only when `snapshot` is requested.
+*/
+
+///! nothing is counted
+struct none
+{
+};
+
+///! count events and high-water mark of occupancy.
+///! Every `LatencySamplePeriod`-th push of each thread is stamped to measure time
+///! from push to pop of this element
+template <std::uint32_t LatencySamplePeriod = 1024>
+    requires(LatencySamplePeriod > 0)
+struct counting
+{
+    static constexpr std::uint32_t latency_sample_period{ LatencySamplePeriod };
+};
+
+template <typename P>
+concept policy = std::same_as<P, none> || requires {
+    { P::latency_sample_period } -> std::convertible_to<std::uint32_t>;
+    requires std::same_as<P, counting<P::latency_sample_period>>;
+};
+
+template <typename P>
+inline constexpr bool enabled{ !std::same_as<P, none> };
+
+enum class event : std::uint8_t
+{
+    push,
+    pop,
+    // CAS of index failed, because other producer (consumer) took the position first
+    push_cas_failure,
+    pop_cas_failure,
+    // push found queue full, counted once per push
+    full,
+    // pop found queue empty
+    empty,
+    // the oldest element was dropped by `overflow::overwrite_oldest`
+    overwrite,
+    // iteration of backoff in blocking or timed push/pop
+    spin,
+    // thread slept in kernel
+    park,
+};
+
+inline constexpr std::size_t events_count{ static_cast<std::size_t>(event::park) + 1 };
+
+///! counters summed over all threads. Approximate, while queue is used concurrently
+struct snapshot
+{
+    std::uint64_t pushes{ 0 };
+    std::uint64_t pops{ 0 };
+    std::uint64_t push_cas_failures{ 0 };
+    std::uint64_t pop_cas_failures{ 0 };
+    std::uint64_t full{ 0 };
+    std::uint64_t empty{ 0 };
+    std::uint64_t overwrites{ 0 };
+    std::uint64_t spins{ 0 };
+    std::uint64_t parks{ 0 };
+
+    ///! max count of elements seen by producer right after push
+    std::uint64_t high_water{ 0 };
+
+    std::uint64_t latency_samples{ 0 };
+    std::chrono::nanoseconds latency_total{ 0 };
+    std::chrono::nanoseconds latency_max{ 0 };
+
+    std::chrono::nanoseconds
+    latency_mean() const noexcept
+    {
+        if (latency_samples == 0) return std::chrono::nanoseconds{ 0 };
+        return latency_total / static_cast<std::chrono::nanoseconds::rep>(latency_samples);
+    }
+};
+
+/*
+    Storage of counters for `Policy`, owned by queue.
+    Stamp is kept in each slot of queue: non-zero, if push was sampled.
+*/
+template <policy Policy>
+class recorder
+{
+public:
+    // `none` makes `stamp_type` empty, so `[[no_unique_address]]` slot member costs nothing
+    struct stamp_type
+    {
+    };
+
+    void
+    add(event, std::uint64_t = 1) noexcept
+    {
+    }
+
+    void
+    update_high_water(std::uint64_t) noexcept
+    {
+    }
+
+    stamp_type
+    stamp_push() noexcept
+    {
+        return {};
+    }
+
+    void
+    record_pop(stamp_type) noexcept
+    {
+    }
+};
+
+template <policy Policy>
+    requires enabled<Policy>
+class recorder<Policy>
+{
+public:
+    using stamp_type = std::int64_t;
+
+    void
+    add(event e, std::uint64_t n = 1) noexcept
+    {
+        current().events[static_cast<std::size_t>(e)].fetch_add(n, std::memory_order::relaxed);
+    }
+
+    void
+    update_high_water(std::uint64_t size) noexcept
+    {
+        std::atomic<std::uint64_t>& hw{ current().high_water };
+        std::uint64_t prev{ hw.load(std::memory_order::relaxed) };
+        while (prev < size && !hw.compare_exchange_weak(prev, size, std::memory_order::relaxed)) {}
+    }
+
+    ///! counts push and decides, if it's sampled
+    ///! @return stamp to keep with element, zero if not sampled
+    stamp_type
+    stamp_push() noexcept
+    {
+        shard& s{ current() };
+        std::uint64_t const n{
+            s.events[static_cast<std::size_t>(event::push)].fetch_add(1, std::memory_order::relaxed)
+        };
+        if (n % Policy::latency_sample_period != 0) return 0;
+        // never zero, steady clock starts long before
+        return std::max<stamp_type>(1, now());
+    }
+
+    ///! counts pop and its latency, if push was sampled
+    void
+    record_pop(stamp_type stamp) noexcept
+    {
+        shard& s{ current() };
+        s.events[static_cast<std::size_t>(event::pop)].fetch_add(1, std::memory_order::relaxed);
+        if (stamp == 0) return;
+
+        auto const latency{ static_cast<std::uint64_t>(std::max<stamp_type>(0, now() - stamp)) };
+        s.latency_samples.fetch_add(1, std::memory_order::relaxed);
+        s.latency_total.fetch_add(latency, std::memory_order::relaxed);
+        std::uint64_t prev{ s.latency_max.load(std::memory_order::relaxed) };
+        while (prev < latency &&
+               !s.latency_max.compare_exchange_weak(prev, latency, std::memory_order::relaxed))
+        {
+        }
+    }
+
+    snapshot
+    get() const noexcept
+    {
+        snapshot r;
+        std::array<std::uint64_t, events_count> events{};
+        std::uint64_t latency_total{ 0 };
+        std::uint64_t latency_max{ 0 };
+        for (shard const& s : m_shards)
+        {
+            for (std::size_t i{ 0 }; i < events_count; ++i)
+                events[i] += s.events[i].load(std::memory_order::relaxed);
+            r.high_water = std::max(r.high_water, s.high_water.load(std::memory_order::relaxed));
+            r.latency_samples += s.latency_samples.load(std::memory_order::relaxed);
+            latency_total += s.latency_total.load(std::memory_order::relaxed);
+            latency_max = std::max(latency_max, s.latency_max.load(std::memory_order::relaxed));
+        }
+
+        auto const count = [&](event e) { return events[static_cast<std::size_t>(e)]; };
+        r.pushes = count(event::push);
+        r.pops = count(event::pop);
+        r.push_cas_failures = count(event::push_cas_failure);
+        r.pop_cas_failures = count(event::pop_cas_failure);
+        r.full = count(event::full);
+        r.empty = count(event::empty);
+        r.overwrites = count(event::overwrite);
+        r.spins = count(event::spin);
+        r.parks = count(event::park);
+        r.latency_total = std::chrono::nanoseconds{ latency_total };
+        r.latency_max = std::chrono::nanoseconds{ latency_max };
+        return r;
+    }
+
+    ///! not atomic with respect to concurrent counting
+    void
+    reset() noexcept
+    {
+        for (shard& s : m_shards)
+        {
+            for (auto& e : s.events) e.store(0, std::memory_order::relaxed);
+            s.high_water.store(0, std::memory_order::relaxed);
+            s.latency_samples.store(0, std::memory_order::relaxed);
+            s.latency_total.store(0, std::memory_order::relaxed);
+            s.latency_max.store(0, std::memory_order::relaxed);
+        }
+    }
+
+private:
+    struct alignas(detail::cache_line_size) shard
+    {
+        std::array<std::atomic<std::uint64_t>, events_count> events{};
+        std::atomic<std::uint64_t> high_water{ 0 };
+        std::atomic<std::uint64_t> latency_samples{ 0 };
+        std::atomic<std::uint64_t> latency_total{ 0 };
+        std::atomic<std::uint64_t> latency_max{ 0 };
+    };
+
+    // the same as counters of `block_pool`: up to `shards_count` threads never share a shard
+    static constexpr std::size_t shards_count{ 16 };
+
+    static stamp_type
+    now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    shard&
+    current() noexcept
+    {
+        return m_shards[detail::thread_index() % shards_count];
+    }
+
+    std::array<shard, shards_count> m_shards;
+};
+
+} // namespace tt::stats
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <tt/detail.hpp>
+#include <tt/unbounded_queue.hpp>
+#include <tt/wait.hpp>
+#include <tt/work_stealing_deque.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tt
+{
+
+/*
+    Fixed pool of worker threads with work stealing.
+
+    Each worker has own `work_stealing_deque`. Tasks spawned by worker go to its deque,
+    so in fork-join workloads nobody contends, until some worker runs out of work
+    and steals from a random victim. Tasks submitted from other threads go
+    to the shared injection queue.
+
+    `parallel_invoke` is the fork-join primitive: the second function is exposed for stealing,
+    while the caller runs the first one and then, while waiting, helps with other tasks.
+    Forked task lives on the stack of the caller, so fork-join doesn't allocate.
+
+    Idle workers spin a bit and then park. Spawning task notifies only if someone is parked.
+
+    Tasks must not throw, exception leads to std::terminate.
+*/
+class thread_pool
+{
+public:
+    using size_type = std::size_t;
+
+    explicit thread_pool(size_type threads_count = std::max(1u,
+                                                            std::thread::hardware_concurrency()))
+    {
+        m_workers.reserve(threads_count);
+        for (size_type i{ 0 }; i < threads_count; ++i)
+            m_workers.push_back(std::make_unique<worker>());
+        for (size_type i{ 0 }; i < threads_count; ++i)
+            m_workers[i]->thread = std::thread{ [this, i] { run_worker(i); } };
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    ///! waits for all submitted tasks
+    ~thread_pool()
+    {
+        wait();
+
+        m_stop.store(true, std::memory_order::relaxed);
+        wake_all();
+        for (auto& w : m_workers) w->thread.join();
+    }
+
+    size_type
+    threads_count() const noexcept
+    {
+        return m_workers.size();
+    }
+
+    ///! runs `fn` asynchronously, use `wait()` to join
+    void
+    submit(std::invocable auto&& fn)
+    {
+        using fn_type = std::decay_t<decltype(fn)>;
+
+        m_pending.fetch_add(1, std::memory_order::relaxed);
+        spawn(new heap_task<fn_type>{ this, std::forward<decltype(fn)>(fn) });
+    }
+
+    ///! waits until all submitted tasks are done, meanwhile runs them in the calling thread.
+    ///! NOTE: must not be called from a task of this pool: the calling task is pending itself,
+    ///!       so it would wait forever. Use `parallel_invoke` to wait for nested tasks
+    void
+    wait()
+    {
+        assert(this_worker() == nullptr && "thread_pool::wait is called from its own task");
+        wait_until([this] { return 0 == m_pending.load(std::memory_order::acquire); });
+    }
+
+    ///! runs both functions, maybe in parallel, and returns when both are done.
+    ///! Unlike `wait`, it can be called from a task, it waits only for `f` and `g`
+    void
+    parallel_invoke(std::invocable auto&& f, std::invocable auto&& g)
+    {
+        using g_type = std::remove_reference_t<decltype(g)>;
+
+        stack_task<g_type> forked{ g };
+        spawn(&forked);
+        run_inline(f);
+        wait_until([&forked] { return forked.done.load(std::memory_order::acquire); });
+    }
+
+    ///! calls `fn` for each element, splitting range in halves until it's not longer than `grain`
+    template <std::random_access_iterator It>
+    void
+    parallel_for_each(It first, It last, std::invocable<std::iter_reference_t<It>> auto&& fn,
+                      std::iter_difference_t<It> grain = 1)
+    {
+        if (last - first <= std::max<std::iter_difference_t<It>>(grain, 1))
+        {
+            run_inline([&] { std::for_each(first, last, fn); });
+            return;
+        }
+
+        It const middle{ first + (last - first) / 2 };
+        parallel_invoke([&] { parallel_for_each(first, middle, fn, grain); },
+                        [&] { parallel_for_each(middle, last, fn, grain); });
+    }
+
+private:
+    struct task
+    {
+        void (*execute)(task*) noexcept;
+    };
+
+    template <typename F>
+    struct stack_task : task
+    {
+        explicit stack_task(F& f)
+            : task{ &stack_task::execute_impl }
+            , fn{ f }
+        {
+        }
+
+        static void
+        execute_impl(task* t) noexcept
+        {
+            auto* const self{ static_cast<stack_task*>(t) };
+            std::invoke(self->fn);
+            self->done.store(true, std::memory_order::release);
+        }
+
+        F& fn;
+        std::atomic<bool> done{ false };
+    };
+
+    template <typename F>
+    struct heap_task : task
+    {
+        heap_task(thread_pool* p, auto&& f)
+            : task{ &heap_task::execute_impl }
+            , pool{ p }
+            , fn{ std::forward<decltype(f)>(f) }
+        {
+        }
+
+        static void
+        execute_impl(task* t) noexcept
+        {
+            thread_pool* const pool{ static_cast<heap_task*>(t)->pool };
+            {
+                // captures are destroyed before `wait()` can return
+                std::unique_ptr<heap_task> const self{ static_cast<heap_task*>(t) };
+                std::invoke(self->fn);
+            }
+            pool->m_pending.fetch_sub(1, std::memory_order::release);
+        }
+
+        thread_pool* pool;
+        F fn;
+    };
+
+    struct worker
+    {
+        work_stealing_deque<task*> deque;
+        std::thread thread;
+    };
+
+    // worker of which pool is the current thread, if any
+    struct current_worker
+    {
+        thread_pool const* pool{ nullptr };
+        worker* self{ nullptr };
+    };
+
+    static current_worker&
+    current() noexcept
+    {
+        thread_local current_worker c;
+        return c;
+    }
+
+    static void
+    run_inline(auto&& fn) noexcept
+    {
+        std::invoke(fn);
+    }
+
+    worker*
+    this_worker() const noexcept
+    {
+        return current().pool == this ? current().self : nullptr;
+    }
+
+    void
+    spawn(task* t)
+    {
+        if (worker* const w{ this_worker() })
+            w->deque.push(t);
+        else
+            m_injected.push_back(t);
+
+        // pairs with fence in `park`: either we see parked worker, or it sees the task
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        if (0 != m_parked.load(std::memory_order::relaxed)) wake_all();
+    }
+
+    task*
+    find_task()
+    {
+        worker* const self{ this_worker() };
+        if (self != nullptr)
+        {
+            if (auto const t{ self->deque.pop() }) return *t;
+        }
+
+        if (auto const t{ m_injected.pop_front() }) return *t;
+
+        // start from random victim, so thieves don't crowd on one deque
+        size_type const start{ static_cast<size_type>(detail::thread_random() % threads_count()) };
+        for (size_type i{ 0 }; i < threads_count(); ++i)
+        {
+            worker& victim{ *m_workers[(start + i) % threads_count()] };
+            if (&victim == self) continue;
+            if (auto const t{ victim.deque.steal() }) return *t;
+        }
+        return nullptr;
+    }
+
+    // runs other tasks, until `done()`
+    void
+    wait_until(std::predicate auto&& done)
+    {
+        wait::backoff<wait::spin_yield> backoff;
+        while (!done())
+        {
+            if (task* const t{ find_task() })
+            {
+                t->execute(t);
+                backoff = {};
+            } else
+            {
+                (void)backoff();
+            }
+        }
+    }
+
+    void
+    run_worker(size_type index)
+    {
+        current() = current_worker{ this, m_workers[index].get() };
+
+        wait::backoff<wait::spin_park> backoff;
+        while (!m_stop.load(std::memory_order::relaxed))
+        {
+            if (task* const t{ find_task() })
+            {
+                t->execute(t);
+                backoff = {};
+            } else if (backoff())
+            {
+                park();
+                backoff = {};
+            }
+        }
+
+        current() = current_worker{};
+    }
+
+    void
+    park()
+    {
+        std::uint32_t const epoch{ m_wake_epoch.load(std::memory_order::acquire) };
+        m_parked.fetch_add(1, std::memory_order::relaxed);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+
+        // the last look, task could be spawned before we announced ourselves
+        if (task* const t{ find_task() })
+        {
+            m_parked.fetch_sub(1, std::memory_order::relaxed);
+            t->execute(t);
+            return;
+        }
+
+        if (!m_stop.load(std::memory_order::relaxed))
+            m_wake_epoch.wait(epoch, std::memory_order::acquire);
+        m_parked.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    void
+    wake_all()
+    {
+        m_wake_epoch.fetch_add(1, std::memory_order::release);
+        m_wake_epoch.notify_all();
+    }
+
+    std::vector<std::unique_ptr<worker>> m_workers;
+    unbounded_queue<task*> m_injected;
+
+    alignas(detail::cache_line_size) std::atomic<size_type> m_pending{ 0 };
+    alignas(detail::cache_line_size) std::atomic<std::uint32_t> m_parked{ 0 };
+    std::atomic<std::uint32_t> m_wake_epoch{ 0 };
+    std::atomic<bool> m_stop{ false };
+};
+
+} // namespace tt
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <tt/detail.hpp>
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+
+namespace tt
+{
+
+/*
+    Latest-value mailbox for exactly one writer and one reader thread.
+
+    Writer fills back buffer in place and publishes it with one atomic exchange,
+    reader takes the newest published buffer with one atomic exchange too.
+    Both are wait-free, never copy `T` and never wait for each other.
+    Snapshots, which were published, but not read before the next publish, are dropped,
+    so unlike queue reader never drains stale entries.
+
+    ```
+        // simulation thread
+        snapshot& s{ box.back() };
+        update(s);
+        box.publish();
+
+        // render thread
+        if (box.update()) draw(box.front());
+    ```
+
+    Three buffers are owned by writer (back), reader (front) and nobody (middle).
+    Publish swaps back and middle, update swaps front and middle,
+    so writer and reader never touch the same buffer.
+
+    NOTE: after publish back buffer contains some older snapshot, not the published one.
+          So writer either rewrites it completely, or keeps its own state separately.
+*/
+template <std::default_initializable T>
+class triple_buffer
+{
+public:
+    using this_type = triple_buffer<T>;
+    using value_type = T;
+
+    triple_buffer() = default;
+
+    ///! all buffers start as copies of `init`, so reader sees it until the first publish
+    explicit triple_buffer(value_type const& init)
+    {
+        for (auto& b : m_buffers) b.value = init;
+    }
+
+    triple_buffer(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    ///! writer only. Buffer to fill before `publish`
+    value_type&
+    back() noexcept
+    {
+        return m_buffers[m_back].value;
+    }
+
+    ///! writer only. Makes back buffer the newest snapshot and gives writer other one
+    void
+    publish() noexcept
+    {
+        // release: reader sees everything written to back buffer.
+        // acquire: reader doesn't read buffer, which writer gets back
+        std::uint8_t const prev{ m_middle.exchange(m_back | dirty, std::memory_order::acq_rel) };
+        m_back = prev & index_mask;
+    }
+
+    ///! writer only. Copies `v` to back buffer and publishes it
+    void
+    write(value_type const& v)
+    {
+        back() = v;
+        publish();
+    }
+
+    ///! reader only. Newest snapshot taken by the last `update`
+    value_type const&
+    front() const noexcept
+    {
+        return m_buffers[m_front].value;
+    }
+
+    ///! reader only. Takes the newest snapshot, if it's published since the previous update.
+    ///! Reference returned by `front` is invalidated if true is returned
+    ///! @return false, if there is nothing new
+    bool
+    update() noexcept
+    {
+        // writer doesn't clear dirty bit, so load is enough to check
+        if (!has_new()) return false;
+
+        std::uint8_t const prev{ m_middle.exchange(m_front, std::memory_order::acq_rel) };
+        m_front = prev & index_mask;
+        return true;
+    }
+
+    ///! reader only. Updates and returns the newest snapshot
+    value_type const&
+    read() noexcept
+    {
+        (void)update();
+        return front();
+    }
+
+    ///! reader only. True, if something is published since the previous `update`
+    bool
+    has_new() const noexcept
+    {
+        return 0 != (m_middle.load(std::memory_order::relaxed) & dirty);
+    }
+
+private:
+    static constexpr std::uint8_t index_mask{ 0b011 };
+    // set by writer, when middle is newer than front
+    static constexpr std::uint8_t dirty{ 0b100 };
+
+    struct alignas(detail::cache_line_size) buffer
+    {
+        value_type value{};
+    };
+
+    std::array<buffer, 3> m_buffers;
+
+    // owned by writer
+    alignas(detail::cache_line_size) std::uint8_t m_back{ 0 };
+    // index of middle buffer and dirty bit
+    alignas(detail::cache_line_size) std::atomic<std::uint8_t> m_middle{ 1 };
+    // owned by reader
+    alignas(detail::cache_line_size) std::uint8_t m_front{ 2 };
+
+    static_assert(decltype(m_middle)::is_always_lock_free);
+};
+
+} // namespace tt
@@ -0,0 +1,408 @@
+#pragma once
+
+#include <tt/detail.hpp>
+#include <tt/lock_free_ringbuf.hpp>
+#include <tt/overflow.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace tt
+{
+
+/*
+    Unbounded lock-free MPMC queue.
+
+    It's a linked list of segments, each is an array of `SegmentCapacity` slots, which are
+    handed out by CAS on index, the same way as in `lock_free_ringbuf`. But slots are never
+    reused inside segment, so each of them is just empty or full and there are no sequences.
+    When tail segment is full, producers link the new one, and when all slots of
+    head segment are taken, consumers move head to the next segment.
+
+    Drained segment can still be touched by threads, which loaded it before head moved,
+    so it's reclaimed with hazard pointers: it's retired and reused only when
+    no thread announces it as hazard. Reused segments go to freelist, so in steady state
+    queue doesn't call allocator at all.
+
+    Hazard records are taken per operation, not per thread, so there is no thread_local state
+    and threads can come and go. The price is one more atomic exchange per push/pop.
+*/
+template <std::destructible T, typename Alloc = std::allocator<T>,
+          std::size_t SegmentCapacity = 256>
+class unbounded_queue
+{
+    static_assert(SegmentCapacity > 0);
+
+public:
+    using this_type = unbounded_queue<T, Alloc, SegmentCapacity>;
+
+    using allocator_type = Alloc;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using value_type = allocator_traits::value_type;
+    using size_type = allocator_traits::size_type;
+
+    static_assert(std::is_same_v<typename allocator_traits::pointer, value_type*>,
+                  "segments are linked by atomic raw pointers, so fancy pointers are unsupported");
+
+    static constexpr size_type segment_capacity{ SegmentCapacity };
+
+private:
+    struct slot_type
+    {
+        alignas(value_type) std::byte storage[sizeof(value_type)];
+        std::atomic<bool> full{ false };
+
+        value_type*
+        value() noexcept
+        {
+            return std::launder(reinterpret_cast<value_type*>(storage));
+        }
+    };
+
+    struct segment
+    {
+        // producers write `last`, consumers write `first`, so they live in different cache lines
+        alignas(detail::cache_line_size) std::atomic<size_type> last{ 0 };
+        alignas(detail::cache_line_size) std::atomic<size_type> first{ 0 };
+        alignas(detail::cache_line_size) std::atomic<segment*> next{ nullptr };
+        std::array<slot_type, SegmentCapacity> slots;
+
+        // @pre nobody can access segment, and all values are already destroyed
+        void
+        reset() noexcept
+        {
+            last.store(0, std::memory_order::relaxed);
+            first.store(0, std::memory_order::relaxed);
+            next.store(nullptr, std::memory_order::relaxed);
+            for (auto& s : slots) s.full.store(false, std::memory_order::relaxed);
+        }
+    };
+
+    using segment_allocator = allocator_traits::template rebind_alloc<segment>;
+    using segment_allocator_traits = std::allocator_traits<segment_allocator>;
+    using segment_list_allocator = allocator_traits::template rebind_alloc<segment*>;
+
+    struct hazard_record
+    {
+        explicit hazard_record(segment_list_allocator const& alloc)
+            : retired{ alloc }
+            , hazards{ alloc }
+        {
+        }
+
+        std::atomic<segment*> hazard{ nullptr };
+        std::atomic<bool> active{ true };
+        // records are never removed, so `next` is immutable after record is published
+        hazard_record* next{ nullptr };
+
+        // used only by owner of record, capacity is kept, so they don't allocate in steady state
+        std::vector<segment*, segment_list_allocator> retired;
+        std::vector<segment*, segment_list_allocator> hazards;
+    };
+
+    using record_allocator = allocator_traits::template rebind_alloc<hazard_record>;
+    using record_allocator_traits = std::allocator_traits<record_allocator>;
+
+    using freelist_type =
+        lock_free_ringbuf<segment*, segment_list_allocator, overflow::reject_newest>;
+
+    // retired segments are scanned for hazards only when there are so many of them
+    static constexpr size_type retire_threshold{ 8 };
+
+public:
+    ///! @pre `freelist_capacity` is power of 2
+    explicit unbounded_queue(size_type freelist_capacity = 8,
+                             allocator_type const& alloc = allocator_type())
+        : m_allocator{ alloc }
+        , m_freelist{ freelist_capacity, segment_list_allocator(alloc) }
+    {
+        segment* const seg{ create_segment() };
+        m_head.store(seg, std::memory_order::relaxed);
+        m_tail.store(seg, std::memory_order::relaxed);
+    }
+
+    unbounded_queue(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    ~unbounded_queue()
+    {
+        for (segment* seg{ m_head.load(std::memory_order::relaxed) }; seg != nullptr;)
+        {
+            size_type const last{ seg->last.load(std::memory_order::relaxed) };
+            for (size_type pos{ seg->first.load(std::memory_order::relaxed) }; pos < last; ++pos)
+                allocator_traits::destroy(m_allocator, seg->slots[pos].value());
+
+            segment* const next{ seg->next.load(std::memory_order::relaxed) };
+            destroy_segment(seg);
+            seg = next;
+        }
+
+        for (hazard_record* r{ m_records.load(std::memory_order::relaxed) }; r != nullptr;)
+        {
+            for (segment* seg : r->retired) destroy_segment(seg);
+
+            hazard_record* const next{ r->next };
+            record_allocator alloc{ m_allocator };
+            record_allocator_traits::destroy(alloc, r);
+            record_allocator_traits::deallocate(alloc, r, 1);
+            r = next;
+        }
+
+        while (auto const seg{ m_freelist.pop_front() }) destroy_segment(*seg);
+    }
+
+    allocator_type
+    get_allocator() const noexcept
+    {
+        return m_allocator;
+    }
+
+    void
+    push_back(value_type const& v)
+    {
+        return emplace_back(v);
+    }
+
+    void
+    push_back(value_type&& v)
+    {
+        return emplace_back(std::forward<value_type>(v));
+    }
+
+    ///! never fails, but can allocate new segment
+    void
+    emplace_back(auto&&... args)
+        requires std::is_constructible_v<value_type, decltype(args)...>
+    {
+        hazard_guard guard{ *this };
+
+        for (;;)
+        {
+            segment* const seg{ guard.protect(m_tail) };
+            size_type pos{ seg->last.load(std::memory_order::relaxed) };
+
+            while (pos < segment_capacity)
+            {
+                // slot is published by `full`, so relaxed is enough for index
+                if (seg->last.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed))
+                {
+                    slot_type& s{ seg->slots[pos] };
+                    allocator_traits::construct(m_allocator, s.value(),
+                                                std::forward<decltype(args)>(args)...);
+                    s.full.store(true, std::memory_order::release);
+                    return;
+                }
+            }
+
+            append_segment(seg);
+        }
+    }
+
+    std::optional<value_type>
+    pop_front()
+        requires std::move_constructible<value_type>
+    {
+        hazard_guard guard{ *this };
+
+        for (;;)
+        {
+            segment* const seg{ guard.protect(m_head) };
+            size_type pos{ seg->first.load(std::memory_order::relaxed) };
+
+            while (pos < segment_capacity)
+            {
+                slot_type& s{ seg->slots[pos] };
+                // acquire pairs with release in `emplace_back`, so value is visible.
+                // Not full slot is either free or still being constructed, queue is empty for us
+                if (!s.full.load(std::memory_order::acquire)) return std::nullopt;
+
+                if (seg->first.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed))
+                {
+                    std::optional<value_type> ret{ std::move(*s.value()) };
+                    allocator_traits::destroy(m_allocator, s.value());
+                    return ret;
+                }
+            }
+
+            // every slot of `seg` is taken, so it's time to move to the next one
+            segment* const next{ seg->next.load(std::memory_order::acquire) };
+            if (next == nullptr) return std::nullopt;
+
+            // tail must not stay on retired segment, otherwise producer could protect it
+            // after it's reclaimed. Tail never moves back, so after this CAS it's behind `seg`
+            segment* expected{ seg };
+            m_tail.compare_exchange_strong(expected, next);
+
+            expected = seg;
+            if (m_head.compare_exchange_strong(expected, next)) guard.retire(seg);
+        }
+    }
+
+private:
+    class hazard_guard
+    {
+    public:
+        explicit hazard_guard(this_type& queue)
+            : m_queue{ queue }
+            , m_record{ queue.acquire_record() }
+        {
+        }
+
+        hazard_guard(hazard_guard const&) = delete;
+        hazard_guard& operator=(hazard_guard const&) = delete;
+
+        ~hazard_guard()
+        {
+            m_record->hazard.store(nullptr, std::memory_order::release);
+            m_record->active.store(false, std::memory_order::release);
+        }
+
+        // announces segment from `src` as hazard, so it's not reclaimed until the guard dies.
+        // seq_cst pairs with seq_cst loads in `scan`: either scanner sees hazard,
+        // or we see that `src` is changed and try again
+        segment*
+        protect(std::atomic<segment*> const& src) noexcept
+        {
+            segment* seg{ src.load(std::memory_order::relaxed) };
+            for (;;)
+            {
+                m_record->hazard.store(seg, std::memory_order::seq_cst);
+                segment* const actual{ src.load(std::memory_order::seq_cst) };
+                if (actual == seg) return seg;
+                seg = actual;
+            }
+        }
+
+        // @pre `seg` is unreachable from head and tail
+        void
+        retire(segment* seg)
+        {
+            m_record->retired.push_back(seg);
+            if (m_record->retired.size() >= retire_threshold) m_queue.scan(*m_record);
+        }
+
+    private:
+        this_type& m_queue;
+        hazard_record* m_record;
+    };
+
+    hazard_record*
+    acquire_record()
+    {
+        for (hazard_record* r{ m_records.load(std::memory_order::acquire) }; r != nullptr;
+             r = r->next)
+        {
+            if (!r->active.load(std::memory_order::relaxed) &&
+                !r->active.exchange(true, std::memory_order::acquire))
+                return r;
+        }
+
+        record_allocator alloc{ m_allocator };
+        hazard_record* const r{ record_allocator_traits::allocate(alloc, 1) };
+        record_allocator_traits::construct(alloc, r, segment_list_allocator(m_allocator));
+
+        r->next = m_records.load(std::memory_order::relaxed);
+        while (!m_records.compare_exchange_weak(r->next, r, std::memory_order::release,
+                                                std::memory_order::relaxed))
+        {
+        }
+        return r;
+    }
+
+    // reclaims retired segments of `record`, which are not hazards of anyone
+    void
+    scan(hazard_record& record)
+    {
+        for (hazard_record* r{ m_records.load(std::memory_order::acquire) }; r != nullptr;
+             r = r->next)
+        {
+            if (segment* const seg{ r->hazard.load(std::memory_order::seq_cst) })
+                record.hazards.push_back(seg);
+        }
+        std::ranges::sort(record.hazards);
+
+        auto const unused{ std::ranges::partition(record.retired, [&](segment* seg) {
+            return std::ranges::binary_search(record.hazards, seg);
+        }) };
+        for (segment* seg : unused) recycle(seg);
+        record.retired.erase(unused.begin(), unused.end());
+        record.hazards.clear();
+    }
+
+    // links the new segment after full `seg` and moves tail to it
+    void
+    append_segment(segment* seg)
+    {
+        segment* next{ seg->next.load(std::memory_order::acquire) };
+        if (next == nullptr)
+        {
+            segment* const fresh{ acquire_segment() };
+            // release publishes reset state of `fresh` to producers and consumers
+            if (seg->next.compare_exchange_strong(next, fresh, std::memory_order::acq_rel,
+                                                  std::memory_order::acquire))
+                next = fresh;
+            else
+                recycle(fresh); // nobody has seen it
+        }
+
+        m_tail.compare_exchange_strong(seg, next);
+    }
+
+    segment*
+    acquire_segment()
+    {
+        if (auto const seg{ m_freelist.pop_front() }) return *seg;
+        return create_segment();
+    }
+
+    // @pre nobody can access `seg`
+    void
+    recycle(segment* seg) noexcept
+    {
+        seg->reset();
+        if (!m_freelist.try_push(seg)) destroy_segment(seg);
+    }
+
+    segment*
+    create_segment()
+    {
+        segment_allocator alloc{ m_allocator };
+        segment* const seg{ segment_allocator_traits::allocate(alloc, 1) };
+        segment_allocator_traits::construct(alloc, seg);
+        return seg;
+    }
+
+    void
+    destroy_segment(segment* seg) noexcept
+    {
+        segment_allocator alloc{ m_allocator };
+        segment_allocator_traits::destroy(alloc, seg);
+        segment_allocator_traits::deallocate(alloc, seg, 1);
+    }
+
+    [[no_unique_address]] allocator_type m_allocator;
+    freelist_type m_freelist;
+    std::atomic<hazard_record*> m_records{ nullptr };
+
+    alignas(detail::cache_line_size) std::atomic<segment*> m_head{ nullptr };
+    alignas(detail::cache_line_size) std::atomic<segment*> m_tail{ nullptr };
+};
+
+namespace pmr
+{
+
+template <std::destructible T, std::size_t SegmentCapacity = 256>
+using unbounded_queue =
+    tt::unbounded_queue<T, std::pmr::polymorphic_allocator<T>, SegmentCapacity>;
+
+} // namespace pmr
+
+} // namespace tt
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+namespace tt::wait
+{
+
+/*
+    How a thread waits for a condition, which will be satisfied by other thread.
+
+    Each strategy at first spins `spins` times, then yields `yields` times,
+    and then, if `parks`, sleeps in kernel (futex on linux) until somebody notifies it.
+
+      - busy_spin is the lowest latency, but burns a core all the time
+      - spin_yield gives core to other threads, but still never sleeps
+      - spin_park sleeps, so idle consumer costs nothing
+*/
+template <typename S>
+concept strategy = requires {
+    { S::spins } -> std::convertible_to<std::uint32_t>;
+    { S::yields } -> std::convertible_to<std::uint32_t>;
+    { S::parks } -> std::convertible_to<bool>;
+};
+
+struct busy_spin
+{
+    static constexpr std::uint32_t spins{ std::numeric_limits<std::uint32_t>::max() };
+    static constexpr std::uint32_t yields{ 0 };
+    static constexpr bool parks{ false };
+};
+
+struct spin_yield
+{
+    static constexpr std::uint32_t spins{ 64 };
+    static constexpr std::uint32_t yields{ std::numeric_limits<std::uint32_t>::max() };
+    static constexpr bool parks{ false };
+};
+
+struct spin_park
+{
+    static constexpr std::uint32_t spins{ 64 };
+    static constexpr std::uint32_t yields{ 16 };
+    static constexpr bool parks{ true };
+};
+
+///! hint to cpu, that we are in spin loop
+inline void
+cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+template <strategy Strategy>
+class backoff
+{
+public:
+    ///! spins or yields once
+    ///! @return true, if it's time to park, nothing is done in this case
+    bool
+    operator()() noexcept
+    {
+        if (m_spins < Strategy::spins)
+        {
+            ++m_spins;
+            cpu_relax();
+            return false;
+        }
+
+        if (m_yields < Strategy::yields || !Strategy::parks)
+        {
+            if (m_yields < Strategy::yields) ++m_yields;
+            std::this_thread::yield();
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    std::uint32_t m_spins{ 0 };
+    std::uint32_t m_yields{ 0 };
+};
+
+/*
+    std::atomic::wait has no timeout, so timed waits can't park.
+    Instead, after spinning and yielding they sleep, each time twice longer, up to `max_sleep`.
+*/
+class timed_backoff
+{
+public:
+    static constexpr std::chrono::microseconds max_sleep{ 1000 };
+
+    template <typename Clock, typename Duration>
+    explicit timed_backoff(std::chrono::time_point<Clock, Duration> deadline)
+        : m_deadline{ std::chrono::time_point_cast<std::chrono::steady_clock::duration>(
+              std::chrono::steady_clock::now() + (deadline - Clock::now())) }
+    {
+    }
+
+    ///! @return false if deadline is reached
+    bool
+    operator()() noexcept
+    {
+        auto const now{ std::chrono::steady_clock::now() };
+        if (now >= m_deadline) return false;
+
+        if (!m_backoff()) return true;
+
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            m_sleep, m_deadline - now));
+        m_sleep = std::min<std::chrono::microseconds>(2 * m_sleep, max_sleep);
+        return true;
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_deadline;
+    std::chrono::microseconds m_sleep{ 1 };
+    backoff<spin_park> m_backoff;
+};
+
+} // namespace tt::wait
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <tt/detail.hpp>
+#include <tt/ringbuf.hpp>
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+namespace tt
+{
+
+namespace window
+{
+
+/*
+    Aggregate over the window is a type with
+      - ctor from window capacity
+      - `push(v)`, called when `v` enters window
+      - `pop(v)`, called when `v`, the oldest element, leaves window
+      - `value()`
+
+    Both `push` and `pop` must be amortized O(1), so nobody rescans window
+*/
+template <typename A, typename T>
+concept aggregate = std::constructible_from<A, std::size_t> && requires(A a, A const ca, T v) {
+    a.push(v);
+    a.pop(v);
+    ca.value();
+};
+
+// NOTE: for floating point `T` error is accumulated with each push/pop pair,
+//       so this is only approximately equal to the sum of window
+template <typename T>
+class sum
+{
+public:
+    explicit sum(std::size_t)
+    {
+    }
+
+    void
+    push(detail::param<T> v)
+    {
+        m_value += v;
+    }
+
+    void
+    pop(detail::param<T> v)
+    {
+        m_value -= v;
+    }
+
+    T
+    value() const
+    {
+        return m_value;
+    }
+
+private:
+    T m_value{};
+};
+
+template <typename T>
+class mean
+{
+public:
+    using value_type = std::common_type_t<T, double>;
+
+    explicit mean(std::size_t capacity)
+        : m_sum{ capacity }
+    {
+    }
+
+    void
+    push(detail::param<T> v)
+    {
+        m_sum.push(v);
+        ++m_count;
+    }
+
+    void
+    pop(detail::param<T> v)
+    {
+        m_sum.pop(v);
+        --m_count;
+    }
+
+    ///! zero for empty window
+    value_type
+    value() const
+    {
+        if (m_count == 0) return value_type{};
+        return static_cast<value_type>(m_sum.value()) / static_cast<value_type>(m_count);
+    }
+
+private:
+    sum<T> m_sum;
+    std::size_t m_count{ 0 };
+};
+
+/*
+    Monotonic deque.
+    Keeps only elements which can become extremum after older ones leave window,
+    so they are sorted by `Compare` and front is the extremum.
+    Each element is pushed and popped from deque at most once - amortized O(1)
+*/
+template <typename T, typename Compare>
+class extremum
+{
+public:
+    explicit extremum(std::size_t capacity)
+        : m_candidates{ capacity }
+    {
+    }
+
+    void
+    push(detail::param<T> v)
+    {
+        while (!m_candidates.empty() && std::invoke(m_compare, v, m_candidates.back()))
+            (void)m_candidates.pop_back();
+        m_candidates.push_back(v);
+    }
+
+    void
+    pop(detail::param<T> v)
+    {
+        if (!m_candidates.empty() && !std::invoke(m_compare, m_candidates.front(), v) &&
+            !std::invoke(m_compare, v, m_candidates.front()))
+            (void)m_candidates.discard_front(1);
+    }
+
+    ///! @pre window is not empty
+    T
+    value() const
+    {
+        return m_candidates.front();
+    }
+
+private:
+    ringbuf<T> m_candidates;
+    [[no_unique_address]] Compare m_compare;
+};
+
+template <typename T>
+using min = extremum<T, std::less<>>;
+
+template <typename T>
+using max = extremum<T, std::greater<>>;
+
+} // namespace window
+
+/*
+    Sliding window over the last `capacity()` pushed elements.
+    `Ops` are updated on each push, so reading any of them is O(1).
+
+    ```
+        tt::windowed_ringbuf<float, tt::window::mean, tt::window::max> frame_times{ 120 };
+        frame_times.push_back(dt);
+        frame_times.aggregate<tt::window::max>();
+    ```
+*/
+template <std::semiregular T, template <typename> typename... Ops>
+    requires(window::aggregate<Ops<T>, T> && ...)
+class windowed_ringbuf
+{
+public:
+    using this_type = windowed_ringbuf<T, Ops...>;
+    using container_type = ringbuf<T>;
+    using value_type = container_type::value_type;
+    using size_type = container_type::size_type;
+    using const_reference = container_type::const_reference;
+
+    explicit windowed_ringbuf(size_type capacity)
+        : m_window{ capacity }
+        , m_ops{ Ops<T>{ capacity }... }
+    {
+    }
+
+    size_type
+    size() const noexcept
+    {
+        return m_window.size();
+    }
+
+    size_type
+    capacity() const noexcept
+    {
+        return m_window.capacity();
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return m_window.empty();
+    }
+
+    bool
+    full() const noexcept
+    {
+        return m_window.full();
+    }
+
+    ///! if window is full, the oldest element leaves it
+    void
+    push_back(value_type const& v)
+    {
+        if (capacity() == 0) return;
+        if (full()) pop_front();
+
+        m_window.push_back(v);
+        std::apply([&v](auto&... op) { (op.push(v), ...); }, m_ops);
+    }
+
+    void
+    pop_front()
+    {
+        if (empty()) return;
+
+        std::apply([this](auto&... op) { (op.pop(m_window.front()), ...); }, m_ops);
+        (void)m_window.discard_front(1);
+    }
+
+    void
+    clear()
+    {
+        m_window.clear();
+        m_ops = std::tuple{ Ops<T>{ capacity() }... };
+    }
+
+    template <template <typename> typename Op>
+    auto
+    aggregate() const
+    {
+        return std::get<Op<T>>(m_ops).value();
+    }
+
+    ///! @pre !empty()
+    const_reference
+    front() const
+    {
+        return m_window.front();
+    }
+
+    ///! @pre !empty()
+    const_reference
+    back() const
+    {
+        return m_window.back();
+    }
+
+    auto
+    begin() const noexcept
+    {
+        return m_window.begin();
+    }
+
+    auto
+    end() const noexcept
+    {
+        return m_window.end();
+    }
+
+private:
+    container_type m_window;
+    std::tuple<Ops<T>...> m_ops;
+};
+
+} // namespace tt
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <tt/detail.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace tt
+{
+
+/*
+    Chase-Lev work-stealing deque.
+
+    The owner thread pushes and pops at the bottom (LIFO, so the hottest task runs first),
+    while any other thread steals from the top (FIFO, so it takes the oldest and usually
+    the biggest task). Owner touches only `m_bottom` and contends with thieves
+    only for the last element.
+
+    Memory orders are taken from N.M. Le et al.
+    "Correct and Efficient Work-Stealing for Weak Memory Models", 2013.
+
+    Thief reads element before it knows, whether it won the race for it,
+    so elements are stored in relaxed atomics and must be trivially copyable, e.g. pointers.
+
+    Storage grows twice, when full. Old arrays can still be read by thieves,
+    so they are kept until the deque dies.
+*/
+template <typename T, typename Alloc = std::allocator<T>>
+    requires std::is_trivially_copyable_v<T>
+class work_stealing_deque
+{
+public:
+    using this_type = work_stealing_deque<T, Alloc>;
+
+    using allocator_type = Alloc;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using value_type = allocator_traits::value_type;
+    using size_type = allocator_traits::size_type;
+
+    static_assert(std::atomic<value_type>::is_always_lock_free);
+
+private:
+    struct array
+    {
+        std::int64_t capacity;
+        array* previous;
+        std::atomic<value_type>* slots;
+
+        std::atomic<value_type>&
+        operator[](std::int64_t i) const noexcept
+        {
+            // capacity is power of 2
+            return slots[i & (capacity - 1)];
+        }
+    };
+
+    using array_allocator = allocator_traits::template rebind_alloc<array>;
+    using array_allocator_traits = std::allocator_traits<array_allocator>;
+    using slot_allocator = allocator_traits::template rebind_alloc<std::atomic<value_type>>;
+    using slot_allocator_traits = std::allocator_traits<slot_allocator>;
+
+public:
+    ///! @pre `capacity` is power of 2
+    explicit work_stealing_deque(size_type capacity = 256,
+                                 allocator_type const& alloc = allocator_type())
+        : m_allocator{ alloc }
+    {
+        assert(detail::is_power_of_2(capacity));
+        m_array.store(create_array(static_cast<std::int64_t>(capacity), nullptr),
+                      std::memory_order::relaxed);
+    }
+
+    work_stealing_deque(this_type const&) = delete;
+    this_type& operator=(this_type const&) = delete;
+
+    ~work_stealing_deque()
+    {
+        for (array* a{ m_array.load(std::memory_order::relaxed) }; a != nullptr;)
+        {
+            array* const previous{ a->previous };
+            destroy_array(a);
+            a = previous;
+        }
+    }
+
+    ///! approximate, if called not by owner
+    size_type
+    size() const noexcept
+    {
+        std::int64_t const b{ m_bottom.load(std::memory_order::relaxed) };
+        std::int64_t const t{ m_top.load(std::memory_order::relaxed) };
+        return b > t ? static_cast<size_type>(b - t) : 0;
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return 0 == size();
+    }
+
+    ///! owner only
+    void
+    push(value_type v)
+    {
+        std::int64_t const b{ m_bottom.load(std::memory_order::relaxed) };
+        std::int64_t const t{ m_top.load(std::memory_order::acquire) };
+        array* a{ m_array.load(std::memory_order::relaxed) };
+
+        if (b - t > a->capacity - 1) a = grow(a, b, t);
+
+        (*a)[b].store(v, std::memory_order::relaxed);
+        // element must be visible before thieves see new bottom.
+        // Le et al. use release fence with relaxed store, it's the same, but visible to tsan
+        m_bottom.store(b + 1, std::memory_order::release);
+    }
+
+    ///! owner only
+    std::optional<value_type>
+    pop()
+    {
+        std::int64_t const b{ m_bottom.load(std::memory_order::relaxed) - 1 };
+        array* const a{ m_array.load(std::memory_order::relaxed) };
+        m_bottom.store(b, std::memory_order::relaxed);
+        // thieves must see decremented bottom before we read top, otherwise
+        // both owner and thief can take the last element
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        std::int64_t t{ m_top.load(std::memory_order::relaxed) };
+
+        if (t > b)
+        {
+            // was empty
+            m_bottom.store(b + 1, std::memory_order::relaxed);
+            return std::nullopt;
+        }
+
+        value_type const v{ (*a)[b].load(std::memory_order::relaxed) };
+        if (t < b) return v;
+
+        // the last element, race with thieves for it
+        bool const won{ m_top.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst,
+                                                      std::memory_order::relaxed) };
+        m_bottom.store(b + 1, std::memory_order::relaxed);
+        return won ? std::optional{ v } : std::nullopt;
+    }
+
+    ///! any thread. Fails also, if other thief won the race for the same element
+    std::optional<value_type>
+    steal()
+    {
+        std::int64_t t{ m_top.load(std::memory_order::acquire) };
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        std::int64_t const b{ m_bottom.load(std::memory_order::acquire) };
+
+        if (t >= b) return std::nullopt;
+
+        // acquire instead of consume, which is discouraged
+        array* const a{ m_array.load(std::memory_order::acquire) };
+        value_type const v{ (*a)[t].load(std::memory_order::relaxed) };
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst,
+                                           std::memory_order::relaxed))
+            return std::nullopt;
+        return v;
+    }
+
+private:
+    array*
+    grow(array* a, std::int64_t b, std::int64_t t)
+    {
+        array* const bigger{ create_array(2 * a->capacity, a) };
+        for (std::int64_t i{ t }; i < b; ++i)
+        {
+            value_type const v{ (*a)[i].load(std::memory_order::relaxed) };
+            (*bigger)[i].store(v, std::memory_order::relaxed);
+        }
+        m_array.store(bigger, std::memory_order::release);
+        return bigger;
+    }
+
+    array*
+    create_array(std::int64_t capacity, array* previous)
+    {
+        array_allocator alloc{ m_allocator };
+        slot_allocator slot_alloc{ m_allocator };
+
+        array* const a{ array_allocator_traits::allocate(alloc, 1) };
+        a->capacity = capacity;
+        a->previous = previous;
+        a->slots = slot_allocator_traits::allocate(slot_alloc, static_cast<size_type>(capacity));
+        for (std::int64_t i{ 0 }; i < capacity; ++i)
+            slot_allocator_traits::construct(slot_alloc, a->slots + i);
+        return a;
+    }
+
+    void
+    destroy_array(array* a) noexcept
+    {
+        array_allocator alloc{ m_allocator };
+        slot_allocator slot_alloc{ m_allocator };
+
+        // atomics of trivially copyable are trivially destructible, nothing to destroy
+        slot_allocator_traits::deallocate(slot_alloc, a->slots,
+                                          static_cast<size_type>(a->capacity));
+        array_allocator_traits::deallocate(alloc, a, 1);
+    }
+
+    // thieves write `m_top`, owner writes `m_bottom`, so they live in different cache lines
+    alignas(detail::cache_line_size) std::atomic<std::int64_t> m_top{ 0 };
+    alignas(detail::cache_line_size) std::atomic<std::int64_t> m_bottom{ 0 };
+    std::atomic<array*> m_array{ nullptr };
+
+    [[no_unique_address]] allocator_type m_allocator;
+};
+
+} // namespace tt
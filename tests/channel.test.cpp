@@ -0,0 +1,183 @@
+#include <doctest/doctest.h>
+
+#include <tt/channel.hpp>
+#include <tt/thread_pool.hpp>
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// coroutine, which starts eagerly and destroys itself at the end
+struct detached
+{
+    struct promise_type
+    {
+        detached
+        get_return_object() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never
+        initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never
+        final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void
+        return_void() noexcept
+        {
+        }
+
+        void
+        unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+
+template <typename Channel>
+detached
+pop_to(Channel& ch, std::optional<int>& out)
+{
+    out = co_await ch.pop();
+}
+
+template <typename Channel>
+detached
+push_all(Channel& ch, std::vector<int> values, int& pushed)
+{
+    for (int v : values)
+    {
+        co_await ch.push(v);
+        ++pushed;
+    }
+}
+
+template <typename Channel>
+detached
+consume(Channel& ch, int count, std::atomic<long>& sum, std::atomic<int>& done)
+{
+    for (int i{ 0 }; i < count; ++i) sum.fetch_add(co_await ch.pop());
+    done.fetch_add(1);
+}
+
+template <typename Channel>
+detached
+produce(Channel& ch, int first, int count, std::atomic<int>& done)
+{
+    for (int i{ first }; i < first + count; ++i) co_await ch.push(i);
+    done.fetch_add(1);
+}
+
+} // namespace
+
+TEST_SUITE("channel")
+{
+    TEST_CASE("pop doesn't suspend, if there is element")
+    {
+        tt::channel<int> ch{ 4 };
+        REQUIRE(ch.try_push(42));
+
+        std::optional<int> v;
+        pop_to(ch, v);
+        REQUIRE_EQ(42, v);
+        REQUIRE(ch.empty());
+    }
+
+    TEST_CASE("push resumes exactly one waiter")
+    {
+        tt::channel<int> ch{ 4 };
+
+        std::optional<int> a;
+        std::optional<int> b;
+        pop_to(ch, a);
+        pop_to(ch, b);
+        REQUIRE_FALSE(a.has_value());
+        REQUIRE_FALSE(b.has_value());
+
+        REQUIRE(ch.try_push(1));
+        REQUIRE_EQ(1, a);
+        REQUIRE_FALSE(b.has_value());
+        REQUIRE(ch.empty());
+
+        REQUIRE(ch.try_push(2));
+        REQUIRE_EQ(2, b);
+        REQUIRE(ch.empty());
+    }
+
+    TEST_CASE("push suspends, while full")
+    {
+        tt::channel<int> ch{ 2 };
+
+        int pushed{ 0 };
+        push_all(ch, { 1, 2, 3, 4, 5 }, pushed);
+        REQUIRE_EQ(2, pushed);
+        REQUIRE_EQ(2, ch.size());
+
+        // each pop lets exactly one suspended push through
+        for (int i{ 1 }; i <= 3; ++i)
+        {
+            REQUIRE_EQ(i, ch.try_pop());
+            REQUIRE_EQ(i + 2, pushed);
+            REQUIRE_EQ(2, ch.size());
+        }
+
+        REQUIRE_EQ(4, ch.try_pop());
+        REQUIRE_EQ(5, ch.try_pop());
+        REQUIRE_EQ(std::nullopt, ch.try_pop());
+    }
+
+    TEST_CASE("ping-pong of two coroutines")
+    {
+        tt::channel<int> ch{ 1 };
+
+        std::atomic<long> sum{ 0 };
+        std::atomic<int> done{ 0 };
+        consume(ch, 100, sum, done);
+        produce(ch, 0, 100, done);
+
+        REQUIRE_EQ(2, done.load());
+        REQUIRE_EQ(100 * 99 / 2, sum.load());
+    }
+
+    TEST_CASE("produce/consume on thread_pool")
+    {
+        tt::thread_pool pool{ 4 };
+        tt::channel<int, tt::thread_pool> ch{ 8, pool };
+
+        constexpr int coroutines_count{ 4 };
+        constexpr int count{ 10'000 };
+
+        std::atomic<long> sum{ 0 };
+        std::atomic<int> done{ 0 };
+        for (int i{ 0 }; i < coroutines_count; ++i)
+        {
+            pool.submit([&] { consume(ch, count, sum, done); });
+            pool.submit([&, i] { produce(ch, i * count, count, done); });
+        }
+
+        while (done.load() != 2 * coroutines_count)
+        {
+            pool.wait();
+            std::this_thread::yield();
+        }
+
+        long const n{ coroutines_count * count };
+        REQUIRE_EQ(n * (n - 1) / 2, sum.load());
+        REQUIRE(ch.empty());
+    }
+}
@@ -0,0 +1,126 @@
+#include <doctest/doctest.h>
+
+#include <tt/frame_arena.hpp>
+#include <tt/lock_free_ringbuf.hpp>
+#include <tt/ringbuf.hpp>
+#include <tt/sharded_queue.hpp>
+#include <tt/sort.hpp>
+#include <tt/spsc_ringbuf.hpp>
+#include <tt/unbounded_queue.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <ranges>
+#include <vector>
+
+namespace
+{
+
+struct counting_resource : std::pmr::memory_resource
+{
+    std::size_t allocated{ 0 };
+    std::size_t deallocated{ 0 };
+
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void
+    do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        deallocated += bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool
+    do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+TEST_SUITE("frame_arena")
+{
+    TEST_CASE("bump and reset")
+    {
+        tt::frame_arena arena{ 1 };
+        REQUIRE_EQ(tt::frame_arena::huge_page_size, arena.capacity());
+        REQUIRE_EQ(0, arena.used());
+
+        void* const a{ arena.allocate(3, 1) };
+        void* const b{ arena.allocate(8, 8) };
+        REQUIRE_EQ(0, reinterpret_cast<std::uintptr_t>(b) % 8);
+        REQUIRE_EQ(static_cast<std::byte*>(a) + 8, b);
+        REQUIRE_EQ(16, arena.used());
+
+        // deallocation does nothing
+        arena.deallocate(b, 8, 8);
+        REQUIRE_EQ(16, arena.used());
+
+        arena.reset();
+        REQUIRE_EQ(0, arena.used());
+        REQUIRE_EQ(16, arena.peak());
+        REQUIRE_EQ(a, arena.allocate(1, 1));
+    }
+
+    TEST_CASE("overflow to upstream")
+    {
+        counting_resource upstream;
+        tt::frame_arena arena{ 1, &upstream };
+        REQUIRE_EQ(&upstream, arena.upstream());
+
+        (void)arena.allocate(arena.capacity() - 8, 1);
+        (void)arena.allocate(16, 1);
+        REQUIRE_EQ(16, arena.overflowed());
+        REQUIRE_NE(0, upstream.allocated);
+
+        arena.reset();
+        REQUIRE_EQ(0, arena.overflowed());
+        REQUIRE_EQ(arena.capacity() + 8, arena.peak());
+        REQUIRE_EQ(upstream.allocated, upstream.deallocated);
+    }
+
+    TEST_CASE("per-frame containers and sort")
+    {
+        tt::frame_arena arena{ 1 };
+
+        for (int frame{ 0 }; frame < 3; ++frame)
+        {
+            {
+                tt::pmr::ringbuf<unsigned> events{ 16, &arena };
+                tt::pmr::lock_free_ringbuf<int> jobs{ 16, &arena };
+                tt::pmr::spsc_ringbuf<int> replies{ 16, &arena };
+                tt::pmr::unbounded_queue<int, 4> log{ 1, &arena };
+                tt::pmr::sharded_queue<int> tasks{ 2, 16, &arena };
+                std::size_t const used{ arena.used() };
+                REQUIRE_NE(0, used);
+
+                for (int i{ 0 }; i < 16; ++i)
+                {
+                    events.push_back(15u - i);
+                    REQUIRE(jobs.try_push(i));
+                    REQUIRE(replies.try_push(i));
+                    log.push_back(i);
+                    REQUIRE(tasks.try_push(i));
+                }
+                // unbounded queue grew, but it's still in arena
+                REQUIRE_LT(used, arena.used());
+
+                std::vector<unsigned> sorted(events.size());
+                tt::counting_sort(events, sorted.begin(), std::identity{}, std::identity{},
+                                  std::pmr::polymorphic_allocator<std::size_t>{ &arena });
+                REQUIRE(std::ranges::is_sorted(sorted));
+                REQUIRE_EQ(0, arena.overflowed());
+            }
+
+            arena.reset();
+        }
+    }
+}
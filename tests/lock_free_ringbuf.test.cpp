@@ -2,6 +2,12 @@
 
 #include <tt/lock_free_ringbuf.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <span>
 #include <thread>
 #include <vector>
 
@@ -184,4 +190,406 @@ TEST_SUITE("lock_free_ringbuif")
         REQUIRE_EQ(counter.load(), -1);
         REQUIRE_EQ(consumed_count.load(), tasks_count + 1);
     }
+
+    TEST_CASE("emplace_back with overwrite of wrapped buffer")
+    {
+        tt::lock_free_ringbuf<int> buf{ 4 };
+        for (int i{ 0 }; i < 10; ++i) buf.emplace_back(i);
+        REQUIRE(buf.full());
+
+        for (int i{ 6 }; i < 10; ++i)
+        {
+            auto const v{ buf.pop_front() };
+            REQUIRE(v.has_value());
+            REQUIRE_EQ(i, *v);
+        }
+        REQUIRE(buf.empty());
+    }
+
+    TEST_CASE("try_push with reject_newest")
+    {
+        tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::reject_newest> buf{ 2 };
+        REQUIRE(buf.try_push(1));
+        REQUIRE(buf.try_push(2));
+        REQUIRE(!buf.try_push(3));
+        buf.emplace_back(4);
+        REQUIRE_EQ(2, buf.size());
+
+        REQUIRE_EQ(1, buf.pop_front());
+        REQUIRE(buf.try_push(5));
+        REQUIRE_EQ(2, buf.pop_front());
+        REQUIRE_EQ(5, buf.pop_front());
+    }
+
+    TEST_CASE("push_back with block")
+    {
+        tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::block> buf{ 1 };
+        buf.push_back(1);
+
+        std::thread producer{ [&] { buf.push_back(2); } };
+        std::optional<int> v;
+        while (!(v = buf.pop_front())) std::this_thread::yield();
+        REQUIRE_EQ(1, *v);
+
+        producer.join();
+        REQUIRE_EQ(2, buf.pop_front());
+    }
+
+    TEST_CASE("produce/consume with block")
+    {
+        using buf_type = tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::block>;
+        buf_type buf{ 4 };
+
+        int const tasks_count{ 10000 };
+        std::uint32_t const threads_count{ 4 };
+        std::atomic<int> consumed_count{ 0 };
+        std::atomic<long> consumed_sum{ 0 };
+
+        std::vector<std::thread> threads;
+        for (std::uint32_t t{ 0 }; t < threads_count; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (int i{ 0 }; i < tasks_count; ++i)
+                        if (static_cast<std::uint32_t>(i) % threads_count == t) buf.push_back(i);
+                });
+            threads.emplace_back(
+                [&]
+                {
+                    while (consumed_count.load() < tasks_count)
+                    {
+                        if (auto const v{ buf.pop_front() })
+                        {
+                            consumed_sum.fetch_add(*v);
+                            consumed_count.fetch_add(1);
+                        }
+                    }
+                });
+        }
+        std::ranges::for_each(threads, [](auto& t) { t.join(); });
+
+        REQUIRE(buf.empty());
+        REQUIRE_EQ(tasks_count, consumed_count.load());
+        REQUIRE_EQ(long{ tasks_count } * (tasks_count - 1) / 2, consumed_sum.load());
+    }
+
+    TEST_CASE("try_push_n/try_pop_n")
+    {
+        tt::lock_free_ringbuf<int> buf{ 4 };
+        std::array const values{ 1, 2, 3, 4, 5, 6 };
+
+        REQUIRE_EQ(3, buf.try_push_n(std::span{ values }.first(3)));
+        REQUIRE_EQ(1, buf.pop_front());
+        REQUIRE_EQ(2, buf.try_push_n(std::span{ values }.subspan(3)));
+        REQUIRE(buf.full());
+        REQUIRE_EQ(0, buf.try_push_n(values));
+
+        std::array<int, 8> out{};
+        REQUIRE_EQ(4, buf.try_pop_n(out));
+        std::array const expected{ 2, 3, 4, 5, 0, 0, 0, 0 };
+        REQUIRE_EQ(expected, out);
+        REQUIRE(buf.empty());
+        REQUIRE_EQ(0, buf.try_pop_n(out));
+    }
+
+    TEST_CASE("produce/consume batches")
+    {
+        tt::lock_free_ringbuf<int> buf{ 64 };
+
+        int const batches_count{ 2000 };
+        std::size_t const batch_size{ 7 };
+        std::uint32_t const threads_count{ 2 };
+        int const per_producer{ batches_count * static_cast<int>(batch_size) };
+        int const tasks_count{ per_producer * static_cast<int>(threads_count) };
+        std::atomic<int> consumed_count{ 0 };
+        std::atomic<long> consumed_sum{ 0 };
+        std::atomic<bool> ordered{ true };
+        std::vector<std::atomic<int>> seen(tasks_count);
+
+        std::vector<std::thread> threads;
+        for (std::uint32_t t{ 0 }; t < threads_count; ++t)
+        {
+            // producer `p` pushes p * per_producer + 0, 1, 2..., so each value is unique
+            threads.emplace_back(
+                [&, producer = static_cast<int>(t)]
+                {
+                    std::array<int, batch_size> batch;
+                    for (int i{ 0 }; i < batches_count; ++i)
+                    {
+                        std::iota(batch.begin(), batch.end(),
+                                  producer * per_producer + i * static_cast<int>(batch_size));
+
+                        std::span<int const> rest{ batch };
+                        while (!rest.empty())
+                        {
+                            rest = rest.subspan(buf.try_push_n(rest));
+                            if (!rest.empty()) std::this_thread::yield();
+                        }
+                    }
+                });
+            threads.emplace_back(
+                [&]
+                {
+                    std::array<int, batch_size + 2> batch;
+                    // each consumer sees elements of one producer in the order they were pushed
+                    std::array<int, threads_count> last;
+                    last.fill(-1);
+                    while (consumed_count.load() < tasks_count)
+                    {
+                        auto const n{ buf.try_pop_n(batch) };
+                        if (n == 0) std::this_thread::yield();
+                        for (int v : std::span{ batch }.first(n))
+                        {
+                            int const producer{ v / per_producer };
+                            if (v <= last[producer]) ordered = false;
+                            last[producer] = v;
+                            seen[v].fetch_add(1);
+                        }
+                        consumed_sum.fetch_add(
+                            std::accumulate(batch.begin(), batch.begin() + n, 0L));
+                        consumed_count.fetch_add(n);
+                    }
+                });
+        }
+        std::ranges::for_each(threads, [](auto& t) { t.join(); });
+
+        REQUIRE(buf.empty());
+        REQUIRE_EQ(tasks_count, consumed_count.load());
+        REQUIRE_EQ(static_cast<long>(tasks_count) * (tasks_count - 1) / 2, consumed_sum.load());
+        REQUIRE(ordered.load());
+        REQUIRE(std::ranges::all_of(seen, [](auto const& c) { return c.load() == 1; }));
+    }
+
+    TEST_CASE("push_wait_for/pop_wait_for timeout")
+    {
+        tt::lock_free_ringbuf<int> buf{ 1 };
+        REQUIRE(!buf.pop_wait_for(std::chrono::milliseconds{ 1 }));
+
+        REQUIRE(buf.push_wait_for(1, std::chrono::milliseconds{ 1 }));
+        REQUIRE(!buf.push_wait_for(2, std::chrono::milliseconds{ 1 }));
+        REQUIRE_EQ(1, buf.pop_wait_for(std::chrono::milliseconds{ 1 }));
+    }
+
+    TEST_CASE("push_wait never overwrites")
+    {
+        tt::lock_free_ringbuf<int> buf{ 1 };
+        buf.push_back(1);
+
+        std::thread producer{ [&] { buf.push_wait(2); } };
+        // give producer a chance to park
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+        REQUIRE_EQ(1, buf.pop_wait());
+
+        producer.join();
+        REQUIRE_EQ(2, buf.pop_wait());
+    }
+
+    template <typename Strategy>
+    void
+    produce_consume_wait()
+    {
+        tt::lock_free_ringbuf<int> buf{ 2 };
+
+        int const tasks_count{ 4000 };
+        int const threads_count{ 2 };
+        std::atomic<long> consumed_sum{ 0 };
+
+        std::vector<std::thread> threads;
+        for (int t{ 0 }; t < threads_count; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (int i{ t }; i < tasks_count; i += threads_count)
+                        buf.template push_wait<Strategy>(i);
+                });
+            threads.emplace_back(
+                [&]
+                {
+                    for (int i{ 0 }; i < tasks_count / threads_count; ++i)
+                        consumed_sum.fetch_add(buf.template pop_wait<Strategy>());
+                });
+        }
+        std::ranges::for_each(threads, [](auto& t) { t.join(); });
+
+        REQUIRE(buf.empty());
+        REQUIRE_EQ(long{ tasks_count } * (tasks_count - 1) / 2, consumed_sum.load());
+    }
+
+    TEST_CASE("produce/consume with push_wait/pop_wait")
+    {
+        SUBCASE("busy_spin")
+        {
+            produce_consume_wait<tt::wait::busy_spin>();
+        }
+        SUBCASE("spin_yield")
+        {
+            produce_consume_wait<tt::wait::spin_yield>();
+        }
+        SUBCASE("spin_park")
+        {
+            produce_consume_wait<tt::wait::spin_park>();
+        }
+    }
+
+    TEST_CASE("try_reserve_back/try_peek_front")
+    {
+        struct immovable
+        {
+            explicit immovable(int v)
+                : value{ v }
+            {
+            }
+            immovable(immovable const&) = delete;
+            immovable& operator=(immovable const&) = delete;
+
+            int const value;
+        };
+
+        tt::lock_free_ringbuf<immovable, std::allocator<immovable>, tt::overflow::reject_newest>
+            buf{ 2 };
+        for (int i{ 0 }; i < 2; ++i)
+        {
+            auto const s{ buf.try_reserve_back() };
+            REQUIRE(s);
+            std::construct_at(s.get(), i);
+            buf.commit_back(s);
+        }
+        REQUIRE(buf.full());
+        REQUIRE(!buf.try_reserve_back());
+
+        auto const s{ buf.try_peek_front() };
+        REQUIRE(s);
+        REQUIRE_EQ(0, s->value);
+        buf.release_front(s);
+        REQUIRE_EQ(1, buf.size());
+        // the rest is destroyed by dtor
+    }
+
+    TEST_CASE("overwrite doesn't discard held element")
+    {
+        tt::lock_free_ringbuf<int> buf{ 4 };
+        for (int i{ 0 }; i < 4; ++i) buf.push_back(i);
+
+        auto const s{ buf.try_peek_front() };
+        REQUIRE(s);
+        REQUIRE_EQ(0, *s);
+
+        // there is room for 100 as soon as 0 is released, so nothing is overwritten
+        std::jthread producer{ [&] { buf.push_back(100); } };
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+        // not REQUIRE: producer can't finish, until the slot is released
+        CHECK_EQ(3, buf.size());
+
+        buf.release_front(s);
+        producer.join();
+
+        REQUIRE_EQ(4, buf.size());
+        for (int expected : { 1, 2, 3, 100 }) REQUIRE_EQ(expected, buf.pop_front());
+        REQUIRE(buf.empty());
+    }
+
+    TEST_CASE("move-only element")
+    {
+        tt::lock_free_ringbuf<std::unique_ptr<int>> buf{ 2 };
+        for (int i{ 0 }; i < 3; ++i) buf.push_back(std::make_unique<int>(i));
+
+        REQUIRE_EQ(1, **buf.pop_front());
+        REQUIRE_EQ(2, **buf.pop_front());
+        REQUIRE(!buf.pop_front());
+    }
+
+    TEST_CASE("stats")
+    {
+        using counting = tt::stats::counting<1>;
+
+        SUBCASE("full, empty and latency")
+        {
+            tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::reject_newest, counting>
+                buf{ 2 };
+            REQUIRE(buf.try_push(1));
+            REQUIRE(buf.try_push(2));
+            REQUIRE_FALSE(buf.try_push(3));
+            REQUIRE_EQ(1, buf.pop_front());
+            REQUIRE_EQ(2, buf.pop_front());
+            REQUIRE_FALSE(buf.pop_front());
+
+            auto const s{ buf.get_stats() };
+            REQUIRE_EQ(2, s.pushes);
+            REQUIRE_EQ(2, s.pops);
+            REQUIRE_EQ(1, s.full);
+            REQUIRE_EQ(1, s.empty);
+            REQUIRE_EQ(0, s.overwrites);
+            REQUIRE_EQ(2, s.high_water);
+            // each push is sampled
+            REQUIRE_EQ(2, s.latency_samples);
+            REQUIRE_LE(s.latency_mean(), s.latency_max);
+
+            buf.reset_stats();
+            REQUIRE_EQ(0, buf.get_stats().pushes);
+        }
+
+        SUBCASE("overwrites")
+        {
+            tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::overwrite_oldest,
+                                  counting>
+                buf{ 2 };
+            for (int i{ 0 }; i < 5; ++i) buf.push_back(i);
+
+            auto const s{ buf.get_stats() };
+            REQUIRE_EQ(5, s.pushes);
+            REQUIRE_EQ(3, s.overwrites);
+            // overwritten elements are not popped by anyone
+            REQUIRE_EQ(0, s.pops);
+        }
+
+        SUBCASE("batches")
+        {
+            tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::reject_newest, counting>
+                buf{ 4 };
+            std::array<int, 6> in{ 1, 2, 3, 4, 5, 6 };
+            REQUIRE_EQ(4, buf.try_push_n(in));
+            REQUIRE_EQ(0, buf.try_push_n(in));
+
+            std::array<int, 6> out{};
+            REQUIRE_EQ(4, buf.try_pop_n(out));
+            REQUIRE_EQ(0, buf.try_pop_n(out));
+
+            auto const s{ buf.get_stats() };
+            REQUIRE_EQ(4, s.pushes);
+            REQUIRE_EQ(4, s.pops);
+            REQUIRE_EQ(1, s.full);
+            REQUIRE_EQ(1, s.empty);
+            REQUIRE_EQ(4, s.high_water);
+        }
+
+        SUBCASE("concurrent")
+        {
+            tt::lock_free_ringbuf<int, std::allocator<int>, tt::overflow::reject_newest,
+                                  tt::stats::counting<>>
+                buf{ 64 };
+            constexpr int threads_count{ 4 };
+            constexpr int count{ 10'000 };
+            {
+                std::vector<std::jthread> threads;
+                for (int t{ 0 }; t < threads_count; ++t)
+                    threads.emplace_back(
+                        [&]
+                        {
+                            for (int i{ 0 }; i < count; ++i)
+                            {
+                                buf.push_wait(i);
+                                (void)buf.pop_wait();
+                            }
+                        });
+            }
+
+            auto const s{ buf.get_stats() };
+            REQUIRE_EQ(threads_count * count, s.pushes);
+            REQUIRE_EQ(threads_count * count, s.pops);
+            REQUIRE_LE(s.high_water, buf.capacity());
+            REQUIRE_LE(s.latency_samples, s.pops);
+        }
+    }
 }
@@ -0,0 +1,93 @@
+#include <doctest/doctest.h>
+
+#include <tt/mapped_ringbuf.hpp>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <stdexcept>
+
+namespace
+{
+
+struct event
+{
+    std::uint32_t id;
+    float value;
+};
+
+struct temp_file
+{
+    std::filesystem::path path{ std::filesystem::temp_directory_path() /
+                                ("tt-mapped-ringbuf-" + std::to_string(::getpid())) };
+
+    temp_file()
+    {
+        std::filesystem::remove(path);
+    }
+
+    ~temp_file()
+    {
+        std::filesystem::remove(path);
+    }
+};
+
+} // namespace
+
+TEST_SUITE("mapped_ringbuf")
+{
+    TEST_CASE("push_back/pop_front with overwrite")
+    {
+        temp_file file;
+        tt::mapped_ringbuf<int> buf{ file.path, 3 };
+        REQUIRE(buf.empty());
+        REQUIRE_EQ(3, buf.capacity());
+
+        for (int i{ 1 }; i <= 5; ++i) buf.push_back(i);
+        REQUIRE(buf.full());
+        REQUIRE_EQ(3, buf.front());
+        REQUIRE_EQ(5, buf.back());
+        REQUIRE(std::ranges::equal(buf.items(), std::array{ 3, 4, 5 }));
+
+        REQUIRE_EQ(3, buf.pop_front());
+        REQUIRE_EQ(2, buf.size());
+    }
+
+    TEST_CASE("reopen")
+    {
+        temp_file file;
+        {
+            tt::mapped_ringbuf<event> buf{ file.path, 4, 2 };
+            for (std::uint32_t i{ 0 }; i < 6; ++i) buf.push_back({ i, i * 0.5f });
+            buf.flush(true);
+        }
+
+        tt::mapped_ringbuf<event> buf{ file.path };
+        REQUIRE_EQ(4, buf.capacity());
+        REQUIRE_EQ(4, buf.size());
+        REQUIRE_EQ(2, buf.front().id);
+        REQUIRE_EQ(5, buf.back().id);
+        REQUIRE_EQ(2.5f, buf.back().value);
+
+        buf.push_back({ 6, 3.f });
+        REQUIRE_EQ(3, buf.front().id);
+    }
+
+    TEST_CASE("incompatible file")
+    {
+        temp_file file;
+        {
+            tt::mapped_ringbuf<int> buf{ file.path, 4 };
+        }
+
+        REQUIRE_THROWS(tt::mapped_ringbuf<int>{ file.path, 8 });
+        REQUIRE_THROWS(tt::mapped_ringbuf<event>{ file.path });
+        REQUIRE_NOTHROW(tt::mapped_ringbuf<int>{ file.path });
+    }
+
+    TEST_CASE("open absent file")
+    {
+        temp_file file;
+        REQUIRE_THROWS(tt::mapped_ringbuf<int>{ file.path });
+    }
+}
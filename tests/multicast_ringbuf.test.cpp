@@ -0,0 +1,165 @@
+#include <doctest/doctest.h>
+
+#include <tt/multicast_ringbuf.hpp>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("multicast_ringbuf")
+{
+    TEST_CASE("each reader sees the whole stream")
+    {
+        tt::multicast_ringbuf<std::string> buf{ 4 };
+        auto& a{ buf.add_reader() };
+        auto& b{ buf.add_reader() };
+
+        buf.push("one");
+        buf.push("two");
+        REQUIRE_EQ(2, a.available());
+        REQUIRE_EQ(2, b.available());
+
+        std::vector<std::string> seen;
+        REQUIRE_EQ(2, a.poll([&](std::string const& s) { seen.push_back(s); }));
+        REQUIRE_EQ(0, a.available());
+        REQUIRE_EQ(2, b.poll([&](std::string const& s) { seen.push_back(s); }));
+        REQUIRE_EQ((std::vector<std::string>{ "one", "two", "one", "two" }), seen);
+        REQUIRE_EQ(2, buf.cursor());
+    }
+
+    TEST_CASE("poll no more than max")
+    {
+        tt::multicast_ringbuf<int> buf{ 8 };
+        auto& r{ buf.add_reader() };
+        for (int i{ 0 }; i < 5; ++i) buf.push(i);
+
+        int sum{ 0 };
+        REQUIRE_EQ(3, r.poll([&](int v) { sum += v; }, 3));
+        REQUIRE_EQ(3, r.cursor());
+        REQUIRE_EQ(2, r.poll([&](int v) { sum += v; }, 3));
+        REQUIRE_EQ(10, sum);
+    }
+
+    TEST_CASE("reader never overtakes dependencies")
+    {
+        tt::multicast_ringbuf<int> buf{ 8 };
+        auto& recorder{ buf.add_reader() };
+        auto& sender{ buf.add_reader({ &recorder }) };
+
+        for (int i{ 0 }; i < 4; ++i) buf.push(i);
+        REQUIRE_EQ(0, sender.available());
+
+        REQUIRE_EQ(2, recorder.poll([](int) {}, 2));
+        REQUIRE_EQ(2, sender.available());
+        REQUIRE_EQ(2, sender.poll([](int) {}));
+        REQUIRE_EQ(0, sender.available());
+    }
+
+    TEST_CASE("block waits for the slowest gating reader")
+    {
+        tt::multicast_ringbuf<int> buf{ 2 };
+        auto& fast{ buf.add_reader() };
+        auto& slow{ buf.add_reader() };
+
+        REQUIRE(buf.try_push(1));
+        REQUIRE(buf.try_push(2));
+        REQUIRE_EQ(2, fast.poll([](int) {}));
+        REQUIRE_FALSE(buf.try_push(3));
+
+        REQUIRE_EQ(1, slow.poll([](int) {}, 1));
+        REQUIRE(buf.try_push(3));
+        REQUIRE_FALSE(buf.try_push(4));
+    }
+
+    TEST_CASE("lapped reader skips lost elements")
+    {
+        tt::multicast_ringbuf<std::uint64_t, std::allocator<std::uint64_t>,
+                              tt::overflow::overwrite_oldest>
+            buf{ 4 };
+        auto& r{ buf.add_reader() };
+
+        for (std::uint64_t i{ 0 }; i < 10; ++i) buf.push(i);
+
+        std::vector<std::uint64_t> seen;
+        REQUIRE_EQ(4, r.poll([&](std::uint64_t v) { seen.push_back(v); }));
+        REQUIRE_EQ((std::vector<std::uint64_t>{ 6, 7, 8, 9 }), seen);
+        REQUIRE_EQ(6, r.lost());
+        REQUIRE_EQ(10, r.cursor());
+    }
+
+    TEST_CASE("writer and readers in threads")
+    {
+        constexpr std::uint64_t count{ 100'000 };
+
+        tt::multicast_ringbuf<std::uint64_t> buf{ 64 };
+        auto& recorder{ buf.add_reader() };
+        auto& sender{ buf.add_reader({ &recorder }) };
+        auto& analytics{ buf.add_reader() };
+
+        auto read = [&](auto& r, std::uint64_t& sum, bool& ordered)
+        {
+            std::uint64_t expected{ 0 };
+            while (expected < count)
+            {
+                r.poll_wait(
+                    [&](std::uint64_t v)
+                    {
+                        ordered = ordered && v == expected;
+                        sum += v;
+                        ++expected;
+                    });
+            }
+        };
+
+        std::uint64_t sums[3]{};
+        bool ordered[3]{ true, true, true };
+        std::jthread t0{ [&] { read(recorder, sums[0], ordered[0]); } };
+        std::jthread t1{ [&] { read(sender, sums[1], ordered[1]); } };
+        std::jthread t2{ [&] { read(analytics, sums[2], ordered[2]); } };
+
+        for (std::uint64_t i{ 0 }; i < count; ++i) buf.push(i);
+
+        t0.join();
+        t1.join();
+        t2.join();
+        for (int i{ 0 }; i < 3; ++i)
+        {
+            REQUIRE(ordered[i]);
+            REQUIRE_EQ(count * (count - 1) / 2, sums[i]);
+        }
+    }
+
+    TEST_CASE("lapped readers in threads")
+    {
+        constexpr std::uint64_t count{ 100'000 };
+
+        tt::multicast_ringbuf<std::uint64_t, std::allocator<std::uint64_t>,
+                              tt::overflow::overwrite_oldest>
+            buf{ 16 };
+        auto& r{ buf.add_reader() };
+
+        std::uint64_t got{ 0 };
+        bool increasing{ true };
+        std::jthread reader{ [&]
+                             {
+                                 std::uint64_t previous{ 0 };
+                                 while (r.cursor() < count)
+                                 {
+                                     r.poll(
+                                         [&](std::uint64_t v)
+                                         {
+                                             increasing = increasing && (got == 0 || v > previous);
+                                             previous = v;
+                                             ++got;
+                                         });
+                                 }
+                             } };
+
+        for (std::uint64_t i{ 0 }; i < count; ++i) buf.push(i);
+        reader.join();
+
+        REQUIRE(increasing);
+        REQUIRE_EQ(count, got + r.lost());
+    }
+}
@@ -0,0 +1,177 @@
+#include <doctest/doctest.h>
+
+#include <tt/lock_free_ringbuf.hpp>
+#include <tt/pool_allocator.hpp>
+#include <tt/ringbuf.hpp>
+#include <tt/sort.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("pool_allocator")
+{
+    TEST_CASE("hits and misses")
+    {
+        tt::block_pool pool{ 64, 2 };
+        REQUIRE_EQ(64, pool.block_size());
+
+        void* const a{ pool.allocate(64) };
+        void* const b{ pool.allocate(1) };
+        REQUIRE(pool.owns(a));
+        REQUIRE(pool.owns(b));
+        REQUIRE_NE(a, b);
+
+        // exhausted
+        void* const c{ pool.allocate(8) };
+        REQUIRE_FALSE(pool.owns(c));
+        // too big
+        void* const d{ pool.allocate(65) };
+        REQUIRE_FALSE(pool.owns(d));
+
+        REQUIRE_EQ(2, pool.get_stats().hits);
+        REQUIRE_EQ(2, pool.get_stats().misses);
+
+        pool.deallocate(d, 65);
+        pool.deallocate(c, 8);
+        pool.deallocate(b, 1);
+        // the last freed block is reused the first
+        REQUIRE_EQ(b, pool.allocate(32));
+        pool.deallocate(b, 32);
+        pool.deallocate(a, 64);
+    }
+
+    TEST_CASE("blocks cached by exited thread go back to pool")
+    {
+        tt::block_pool pool{ 16, 8 };
+
+        std::thread{ [&pool]
+                     {
+                         std::vector<void*> blocks;
+                         for (int i{ 0 }; i < 8; ++i) blocks.push_back(pool.allocate(16));
+                         for (void* b : blocks) pool.deallocate(b, 16);
+                     } }
+            .join();
+
+        std::vector<void*> blocks;
+        for (int i{ 0 }; i < 8; ++i) blocks.push_back(pool.allocate(16));
+        REQUIRE(std::ranges::all_of(blocks, [&](void* b) { return pool.owns(b); }));
+        for (void* b : blocks) pool.deallocate(b, 16);
+    }
+
+    TEST_CASE("thread using more pools than it caches goes to shared stack")
+    {
+        std::vector<std::unique_ptr<tt::block_pool>> pools;
+        for (int i{ 0 }; i < 6; ++i) pools.push_back(std::make_unique<tt::block_pool>(16, 2));
+
+        std::vector<void*> blocks(pools.size());
+        std::atomic<bool> freed{ false };
+        std::atomic<bool> checked{ false };
+        std::thread user{ [&]
+                          {
+                              // each of the first 4 pools caches its second block
+                              for (std::size_t i{ 0 }; i < pools.size(); ++i)
+                                  blocks[i] = pools[i]->allocate(16);
+                              for (std::size_t i{ 4 }; i < pools.size(); ++i)
+                                  pools[i]->deallocate(blocks[i], 16);
+
+                              freed = true;
+                              freed.notify_one();
+                              checked.wait(false);
+                              for (std::size_t i{ 0 }; i < 4; ++i)
+                                  pools[i]->deallocate(blocks[i], 16);
+                          } };
+
+        freed.wait(false);
+        // the last pools were not cached by `user`, so both their blocks are shared
+        for (std::size_t i{ 4 }; i < pools.size(); ++i)
+        {
+            void* const a{ pools[i]->allocate(16) };
+            void* const b{ pools[i]->allocate(16) };
+            // not REQUIRE: `user` must be released anyway
+            CHECK(pools[i]->owns(a));
+            CHECK(pools[i]->owns(b));
+            pools[i]->deallocate(a, 16);
+            pools[i]->deallocate(b, 16);
+        }
+
+        checked = true;
+        checked.notify_one();
+        user.join();
+    }
+
+    TEST_CASE("as Alloc of containers")
+    {
+        tt::block_pool pool{ 1024, 4, tt::detail::cache_line_size };
+
+        {
+            tt::ringbuf<int, tt::pool_allocator<int>> buf{ 8, tt::pool_allocator<int>{ pool } };
+            for (int i{ 0 }; i < 10; ++i) buf.push_back(i);
+            REQUIRE_EQ(2, buf.front());
+
+            auto copy{ buf };
+            REQUIRE_EQ(&pool, copy.get_allocator().pool());
+            REQUIRE_EQ(8, copy.size());
+        }
+
+        {
+            tt::pool_allocator<int> const alloc{ pool };
+            tt::lock_free_ringbuf<int, tt::pool_allocator<int>> buf{ 8, alloc };
+            buf.push_back(42);
+            REQUIRE_EQ(42, buf.pop_front());
+        }
+
+        {
+            std::vector<std::uint8_t> in{ 3, 1, 2, 1 };
+            std::vector<std::uint8_t> out(in.size());
+            tt::counting_sort(in, out.begin(), std::identity{}, std::identity{},
+                              tt::pool_allocator<std::size_t>{ pool });
+            REQUIRE_EQ((std::vector<std::uint8_t>{ 1, 1, 2, 3 }), out);
+        }
+
+        auto const stats{ pool.get_stats() };
+        REQUIRE_EQ(4, stats.hits);
+        REQUIRE_EQ(0, stats.misses);
+    }
+
+    TEST_CASE("default constructed allocator has no pool")
+    {
+        tt::pool_allocator<int> alloc;
+        REQUIRE_EQ(nullptr, alloc.pool());
+
+        int* const p{ alloc.allocate(4) };
+        p[3] = 42;
+        alloc.deallocate(p, 4);
+        REQUIRE(alloc == tt::pool_allocator<long>{});
+    }
+
+    TEST_CASE("nodes churn in threads")
+    {
+        tt::block_pool pool{ 64, 512 };
+
+        auto churn = [&pool](int id)
+        {
+            std::list<int, tt::pool_allocator<int>> list{ tt::pool_allocator<int>{ pool } };
+            for (int round{ 0 }; round < 1000; ++round)
+            {
+                for (int i{ 0 }; i < 32; ++i) list.push_back(id);
+                // nobody else got the same node
+                REQUIRE(std::ranges::all_of(list, [id](int v) { return v == id; }));
+                list.clear();
+            }
+        };
+
+        std::vector<std::jthread> threads;
+        for (int id{ 0 }; id < 4; ++id) threads.emplace_back(churn, id);
+        threads.clear();
+
+        auto const stats{ pool.get_stats() };
+        REQUIRE_EQ(4 * 1000 * 32, stats.hits + stats.misses);
+        REQUIRE_EQ(0, stats.misses);
+    }
+}
@@ -2,7 +2,70 @@
 
 #include <tt/ringbuf.hpp>
 
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include <ranges>
+#include <stdexcept>
+
+namespace
+{
+
+// throws from copy ctor, when `copies_left` reaches zero. Move can throw too, so it's not declared
+struct throwing_copy
+{
+    static inline int live{ 0 };
+    static inline int copies_left{ 0 };
+
+    explicit throwing_copy(int v)
+        : value{ v }
+    {
+        ++live;
+    }
+
+    throwing_copy(throwing_copy const& other)
+        : value{ other.value }
+    {
+        if (copies_left-- == 0) throw std::runtime_error{ "copy" };
+        ++live;
+    }
+
+    ~throwing_copy()
+    {
+        --live;
+    }
+
+    int value;
+};
+
+struct counting_resource : std::pmr::memory_resource
+{
+    std::size_t allocated{ 0 };
+    std::size_t deallocated{ 0 };
+
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void
+    do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        deallocated += bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool
+    do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace
 
 TEST_SUITE("ringbuf")
 {
@@ -167,4 +230,264 @@ TEST_SUITE("ringbuf")
         REQUIRE(buf.empty());
         REQUIRE_EQ(0, buf.size());
     }
+
+    TEST_CASE("grow on full emplace_back")
+    {
+        tt::ringbuf<int, std::allocator<int>, tt::overflow::grow> buf{ 0 };
+        for (int i{ 0 }; i < 100; ++i) buf.emplace_back(i);
+        REQUIRE_EQ(100, buf.size());
+        REQUIRE_EQ(128, buf.capacity());
+        REQUIRE(std::ranges::equal(buf, std::views::iota(0, 100)));
+    }
+
+    TEST_CASE("grow linearises wrapped buffer")
+    {
+        tt::ringbuf<int, std::allocator<int>, tt::overflow::grow> buf{ 4 };
+        buf.append_range(std::array{ 1, 2, 3, 4 } | std::views::all);
+        (void)buf.pop_front();
+        (void)buf.pop_front();
+        buf.emplace_back(5);
+        buf.emplace_back(6);
+        REQUIRE(buf.full());
+
+        buf.emplace_back(*buf.begin());
+        REQUIRE_EQ(8, buf.capacity());
+        REQUIRE(std::ranges::equal(buf, std::array{ 3, 4, 5, 6, 3 }));
+
+        auto const v{ buf.pop_front() };
+        REQUIRE(v.has_value());
+        REQUIRE_EQ(3, *v);
+    }
+
+    TEST_CASE("reserve_capacity/shrink_to_fit")
+    {
+        tt::ringbuf<int> buf{ 3 };
+        buf.append_range(std::array{ 1, 2, 3, 4 } | std::views::all);
+
+        buf.reserve_capacity(2);
+        REQUIRE_EQ(3, buf.capacity());
+
+        buf.reserve_capacity(10);
+        REQUIRE_EQ(10, buf.capacity());
+        REQUIRE_EQ(7, buf.reserve());
+        REQUIRE(std::ranges::equal(buf, std::array{ 2, 3, 4 }));
+
+        buf.shrink_to_fit();
+        REQUIRE_EQ(3, buf.capacity());
+        REQUIRE(buf.full());
+        REQUIRE(std::ranges::equal(buf, std::array{ 2, 3, 4 }));
+    }
+
+    TEST_CASE("grow is exception safe")
+    {
+        counting_resource resource;
+        {
+            tt::pmr::ringbuf<throwing_copy, tt::overflow::grow> buf{ 2, &resource };
+            buf.emplace_back(1);
+            buf.emplace_back(2);
+            auto const values = [&]
+            { return buf | std::views::transform([](auto const& v) { return v.value; }); };
+
+            SUBCASE("new element throws")
+            {
+                throwing_copy const v{ 3 };
+                throwing_copy::copies_left = 0;
+                REQUIRE_THROWS(buf.push_back(v));
+            }
+            SUBCASE("relocation throws")
+            {
+                throwing_copy const v{ 3 };
+                throwing_copy::copies_left = 2;
+                REQUIRE_THROWS(buf.push_back(v));
+            }
+            SUBCASE("reserve_capacity throws")
+            {
+                throwing_copy::copies_left = 1;
+                REQUIRE_THROWS(buf.reserve_capacity(4));
+            }
+
+            REQUIRE_EQ(2, buf.capacity());
+            REQUIRE(std::ranges::equal(values(), std::array{ 1, 2 }));
+            REQUIRE_EQ(2, throwing_copy::live);
+        }
+        REQUIRE_EQ(0, throwing_copy::live);
+        REQUIRE_EQ(resource.allocated, resource.deallocated);
+    }
+
+    TEST_CASE("try_push with reject_newest")
+    {
+        tt::ringbuf<int, std::allocator<int>, tt::overflow::reject_newest> buf{ 2 };
+        REQUIRE(buf.try_push(1));
+        REQUIRE(buf.try_push(2));
+        REQUIRE(!buf.try_push(3));
+        buf.emplace_back(4);
+        REQUIRE(std::ranges::equal(buf, std::array{ 1, 2 }));
+
+        tt::ringbuf<int> overwriting{ 1 };
+        REQUIRE(overwriting.try_push(1));
+        REQUIRE(overwriting.try_push(2));
+        REQUIRE_EQ(2, *overwriting.begin());
+    }
+
+    TEST_CASE("front/back")
+    {
+        tt::ringbuf<int> buf{ 3 };
+        buf.append_range(std::array{ 1, 2, 3, 4 } | std::views::all);
+        REQUIRE_EQ(2, buf.front());
+        REQUIRE_EQ(4, buf.back());
+
+        buf.front() = 5;
+        buf.back() = 6;
+        REQUIRE(std::ranges::equal(buf, std::array{ 5, 3, 6 }));
+    }
+
+    TEST_CASE("pop_front_into")
+    {
+        tt::ringbuf<std::vector<int>> buf{ 2 };
+        buf.emplace_back(3uz, 42);
+
+        std::vector<int> v;
+        REQUIRE(buf.pop_front_into(v));
+        std::vector const expected{ 42, 42, 42 };
+        REQUIRE_EQ(expected, v);
+        REQUIRE(buf.empty());
+
+        REQUIRE(!buf.pop_front_into(v));
+        REQUIRE_EQ(3, v.size());
+    }
+
+    TEST_CASE("discard_front")
+    {
+        tt::ringbuf<int> buf{ 4 };
+        buf.append_range(std::array{ 1, 2, 3, 4, 5, 6 } | std::views::all);
+
+        REQUIRE_EQ(3, buf.discard_front(3));
+        REQUIRE(std::ranges::equal(buf, std::array{ 6 }));
+        REQUIRE_EQ(1, buf.discard_front(10));
+        REQUIRE(buf.empty());
+
+        tt::ringbuf<std::vector<int>> vectors{ 2 };
+        vectors.emplace_back(1uz, 1);
+        vectors.emplace_back(2uz, 2);
+        REQUIRE_EQ(1, vectors.discard_front(1));
+        REQUIRE_EQ(2, vectors.front().size());
+    }
+
+    TEST_CASE("consume_front")
+    {
+        tt::ringbuf<int> buf{ 4 };
+        buf.append_range(std::array{ 1, 2, 3, 4, 5, 6 } | std::views::all);
+
+        std::vector<int> consumed;
+        REQUIRE_EQ(3, buf.consume_front(3, [&](int& v) { consumed.push_back(v); }));
+        std::vector const expected{ 3, 4, 5 };
+        REQUIRE_EQ(expected, consumed);
+        REQUIRE_EQ(1, buf.size());
+        REQUIRE_EQ(6, buf.front());
+
+        REQUIRE_EQ(1, buf.consume_front(3, [&](int& v) { consumed.push_back(v); }));
+        REQUIRE(buf.empty());
+    }
+
+    TEST_CASE("move ctor")
+    {
+        tt::ringbuf<int> buf1{ 3 };
+        buf1.append_range(std::array{ 1, 2, 3, 4 } | std::views::all);
+
+        tt::ringbuf<int> buf2{ std::move(buf1) };
+        REQUIRE_EQ(3, buf2.capacity());
+        REQUIRE(std::ranges::equal(buf2, std::array{ 2, 3, 4 }));
+    }
+
+    TEST_CASE("try_reserve_back/try_peek_front")
+    {
+        // neither default constructible nor copyable nor assignable
+        struct immovable
+        {
+            explicit immovable(int v)
+                : value{ v }
+            {
+            }
+            immovable(immovable const&) = delete;
+            immovable& operator=(immovable const&) = delete;
+
+            int const value;
+        };
+
+        tt::ringbuf<immovable, std::allocator<immovable>, tt::overflow::reject_newest> buf{ 2 };
+        for (int i{ 0 }; i < 2; ++i)
+        {
+            auto const p{ buf.try_reserve_back() };
+            REQUIRE(p != nullptr);
+            std::construct_at(p, i);
+            buf.commit_back(p);
+        }
+        REQUIRE(buf.full());
+        REQUIRE(buf.try_reserve_back() == nullptr);
+
+        auto const p{ buf.try_peek_front() };
+        REQUIRE(p != nullptr);
+        REQUIRE_EQ(0, p->value);
+        buf.release_front(p);
+        REQUIRE_EQ(1, buf.size());
+        REQUIRE_EQ(1, buf.front().value);
+    }
+
+    TEST_CASE("try_reserve_back with overwrite")
+    {
+        tt::ringbuf<int> buf{ 2 };
+        buf.append_range(std::array{ 1, 2 } | std::views::all);
+
+        auto const p{ buf.try_reserve_back() };
+        // the oldest is already dropped
+        REQUIRE_EQ(1, buf.size());
+        REQUIRE_EQ(2, buf.front());
+        std::construct_at(p, 3);
+        buf.commit_back(p);
+        REQUIRE(std::ranges::equal(buf, std::array{ 2, 3 }));
+    }
+
+    TEST_CASE("move-only element")
+    {
+        tt::ringbuf<std::unique_ptr<int>> buf{ 2 };
+        for (int i{ 0 }; i < 3; ++i) buf.push_back(std::make_unique<int>(i));
+
+        REQUIRE_EQ(1, **buf.pop_front());
+        REQUIRE_EQ(2, **buf.pop_front());
+        REQUIRE(buf.empty());
+    }
+
+    TEST_CASE("pmr allocator propagation")
+    {
+        std::array<std::byte, 1024> storage1;
+        std::array<std::byte, 1024> storage2;
+        std::pmr::monotonic_buffer_resource r1{ storage1.data(), storage1.size() };
+        std::pmr::monotonic_buffer_resource r2{ storage2.data(), storage2.size() };
+
+        tt::pmr::ringbuf<int> buf1{ 4, &r1 };
+        buf1.append_range(std::array{ 1, 2, 3 } | std::views::all);
+
+        // copy doesn't inherit memory resource, like `std::pmr::vector`
+        tt::pmr::ringbuf<int> const copy{ buf1 };
+        REQUIRE_EQ(std::pmr::get_default_resource(), copy.get_allocator().resource());
+        REQUIRE_EQ(buf1, copy);
+
+        tt::pmr::ringbuf<int> buf2{ 2, &r2 };
+        buf2 = buf1;
+        REQUIRE_EQ(&r2, buf2.get_allocator().resource());
+        REQUIRE_EQ(buf1, buf2);
+
+        // different resources, so elements are moved one by one
+        tt::pmr::ringbuf<int> buf3{ 0, &r2 };
+        buf3 = std::move(buf1);
+        REQUIRE_EQ(&r2, buf3.get_allocator().resource());
+        REQUIRE_EQ(buf2, buf3);
+
+        tt::pmr::ringbuf<int> const moved{ std::move(buf3) };
+        REQUIRE_EQ(&r2, moved.get_allocator().resource());
+        REQUIRE_EQ(buf2, moved);
+
+        swap(buf2, buf3);
+        REQUIRE_EQ(moved, buf3);
+    }
 }
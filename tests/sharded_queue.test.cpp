@@ -0,0 +1,91 @@
+#include <doctest/doctest.h>
+
+#include <tt/sharded_queue.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("sharded_queue")
+{
+    TEST_CASE("one thread keeps fifo")
+    {
+        tt::sharded_queue<int> queue{ 4, 8 };
+        REQUIRE_EQ(4, queue.shards_count());
+        REQUIRE_EQ(32, queue.capacity());
+        REQUIRE(queue.empty());
+
+        for (int i{ 0 }; i < 8; ++i) REQUIRE(queue.try_push(i));
+        REQUIRE_EQ(8, queue.size());
+        for (int i{ 0 }; i < 8; ++i) REQUIRE_EQ(i, queue.pop_front());
+        REQUIRE(!queue.pop_front());
+    }
+
+    TEST_CASE("spills to other shards when full")
+    {
+        tt::sharded_queue<int> queue{ 2, 2 };
+        for (int i{ 0 }; i < 4; ++i) REQUIRE(queue.try_push(i));
+        REQUIRE(!queue.try_push(4));
+
+        std::vector<int> popped;
+        while (auto const v{ queue.pop_front() }) popped.push_back(*v);
+        std::ranges::sort(popped);
+        std::vector const expected{ 0, 1, 2, 3 };
+        REQUIRE_EQ(expected, popped);
+    }
+
+    template <typename Strategy>
+    void
+    produce_consume()
+    {
+        tt::sharded_queue<int, std::allocator<int>, Strategy> queue{ 4, 64 };
+
+        int const tasks_count{ 20000 };
+        int const threads_count{ 3 };
+        std::atomic<int> consumed_count{ 0 };
+        std::atomic<long> consumed_sum{ 0 };
+
+        std::vector<std::thread> threads;
+        for (int t{ 0 }; t < threads_count; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (int i{ t }; i < tasks_count; i += threads_count)
+                        while (!queue.try_push(i)) std::this_thread::yield();
+                });
+            threads.emplace_back(
+                [&]
+                {
+                    while (consumed_count.load() < tasks_count)
+                    {
+                        if (auto const v{ queue.pop_front() })
+                        {
+                            consumed_sum.fetch_add(*v);
+                            consumed_count.fetch_add(1);
+                        } else
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+        }
+        std::ranges::for_each(threads, [](auto& t) { t.join(); });
+
+        REQUIRE(queue.empty());
+        REQUIRE_EQ(long{ tasks_count } * (tasks_count - 1) / 2, consumed_sum.load());
+    }
+
+    TEST_CASE("produce/consume")
+    {
+        SUBCASE("round_robin")
+        {
+            produce_consume<tt::steal::round_robin>();
+        }
+        SUBCASE("two_choices")
+        {
+            produce_consume<tt::steal::two_choices>();
+        }
+    }
+}
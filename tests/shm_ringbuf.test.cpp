@@ -0,0 +1,136 @@
+#include <doctest/doctest.h>
+
+#include <tt/shm_ringbuf.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+
+struct event
+{
+    std::uint32_t id;
+    float value;
+};
+
+struct temp_name
+{
+    std::string name{ "/tt-shm-ringbuf-" + std::to_string(::getpid()) };
+
+    temp_name()
+    {
+        tt::shm_ringbuf<int>::unlink(name);
+    }
+
+    ~temp_name()
+    {
+        tt::shm_ringbuf<int>::unlink(name);
+    }
+};
+
+} // namespace
+
+TEST_SUITE("shm_ringbuf")
+{
+    TEST_CASE("try_push/pop_front")
+    {
+        auto buf{ tt::shm_ringbuf<event>::anonymous(2) };
+        REQUIRE(buf.empty());
+        REQUIRE_EQ(2, buf.capacity());
+
+        REQUIRE(buf.try_push({ 1, 1.5f }));
+        REQUIRE(buf.try_push({ 2, 2.5f }));
+        REQUIRE(buf.full());
+        REQUIRE_FALSE(buf.try_push({ 3, 3.5f }));
+
+        auto const e{ buf.pop_front() };
+        REQUIRE(e.has_value());
+        REQUIRE_EQ(1, e->id);
+        REQUIRE_EQ(1.5f, e->value);
+        REQUIRE_EQ(2, buf.pop_front()->id);
+        REQUIRE_FALSE(buf.pop_front().has_value());
+    }
+
+    TEST_CASE("two mappings of the same region")
+    {
+        temp_name name;
+        tt::shm_ringbuf<int> producer{ name.name, 4 };
+        tt::shm_ringbuf<int> consumer{ name.name };
+        REQUIRE_EQ(4, consumer.capacity());
+
+        for (int i{ 0 }; i < 10; ++i)
+        {
+            REQUIRE(producer.try_push(i));
+            REQUIRE_EQ(i, consumer.pop_front());
+        }
+
+        // the same name and capacity attaches too
+        tt::shm_ringbuf<int> other{ name.name, 4 };
+        REQUIRE(other.try_push(42));
+        REQUIRE_EQ(42, consumer.pop_front());
+    }
+
+    TEST_CASE("incompatible region")
+    {
+        temp_name name;
+        tt::shm_ringbuf<int> buf{ name.name, 4 };
+
+        REQUIRE_THROWS(tt::shm_ringbuf<int>{ name.name, 8 });
+        REQUIRE_THROWS(tt::shm_ringbuf<event>{ name.name });
+        REQUIRE_THROWS(tt::shm_ringbuf<int>{ name.name + "-absent" });
+    }
+
+    TEST_CASE("from_fd")
+    {
+        auto buf{ tt::shm_ringbuf<int>::anonymous(4) };
+        auto attached{ tt::shm_ringbuf<int>::from_fd(::dup(buf.fd())) };
+
+        REQUIRE(buf.try_push(7));
+        REQUIRE_EQ(7, attached.pop_front());
+    }
+
+    TEST_CASE("wait timeouts")
+    {
+        auto buf{ tt::shm_ringbuf<int>::anonymous(1) };
+
+        REQUIRE_FALSE(buf.pop_wait_for(std::chrono::milliseconds{ 10 }).has_value());
+        REQUIRE(buf.push_wait_for(1, std::chrono::milliseconds{ 10 }));
+        REQUIRE_FALSE(buf.push_wait_for(2, std::chrono::milliseconds{ 10 }));
+        REQUIRE_EQ(1, buf.pop_wait_for(std::chrono::milliseconds{ 10 }));
+    }
+
+    TEST_CASE("produce/consume between processes")
+    {
+        auto buf{ tt::shm_ringbuf<std::int64_t>::anonymous(8) };
+        constexpr std::int64_t count{ 100'000 };
+
+        pid_t const child{ ::fork() };
+        REQUIRE_NE(-1, child);
+        if (0 == child)
+        {
+            for (std::int64_t i{ 0 }; i < count; ++i) buf.push_wait(i);
+            ::_exit(0);
+        }
+
+        std::int64_t sum{ 0 };
+        bool ordered{ true };
+        for (std::int64_t i{ 0 }; i < count; ++i)
+        {
+            std::int64_t const v{ buf.pop_wait() };
+            ordered = ordered && v == i;
+            sum += v;
+        }
+
+        int status{ 0 };
+        REQUIRE_EQ(child, ::waitpid(child, &status, 0));
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(ordered);
+        REQUIRE_EQ(count * (count - 1) / 2, sum);
+        REQUIRE(buf.empty());
+    }
+}
@@ -3,6 +3,7 @@
 #include <tt/sort.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <format>
 #include <iostream>
 #include <memory_resource>
@@ -152,4 +153,44 @@ TEST_SUITE("sort")
         tt::radix_sort(std::vector{ ar }, begin(res));
         CHECK_EQ(res, sorted(ar));
     }
+
+    TEST_CASE("radix sort phase timings")
+    {
+        std::vector<std::uint32_t> ar(1000);
+        std::ranges::generate(ar, [] { return std::rand(); });
+        std::vector<std::uint32_t> res(ar.size());
+
+        tt::sort_phase_timings timings;
+        tt::radix_sort(std::vector{ ar }, begin(res), std::identity{}, std::identity{},
+                       tt::byte_radix_traits<std::uint32_t>{}, timings);
+        std::ranges::sort(ar);
+        CHECK_EQ(res, ar);
+
+        // pass per byte
+        REQUIRE_EQ(4, timings.passes.size());
+        std::size_t const bytes{ ar.size() * sizeof(std::uint32_t) };
+        for (auto const& pass : timings.passes)
+        {
+            CHECK_EQ(bytes, pass[static_cast<std::size_t>(tt::sort_phase::histogram)].bytes);
+            CHECK_EQ(256 * sizeof(std::size_t),
+                     pass[static_cast<std::size_t>(tt::sort_phase::prefix_sum)].bytes);
+            CHECK_EQ(bytes, pass[static_cast<std::size_t>(tt::sort_phase::scatter)].bytes);
+        }
+        // the last pass also moves result to output
+        CHECK_EQ(5 * bytes, timings.total(tt::sort_phase::copy_back).bytes);
+        CHECK_EQ(2 * bytes,
+                 timings.passes.back()[static_cast<std::size_t>(tt::sort_phase::copy_back)].bytes);
+
+        // timings are summed over sorts
+        tt::radix_sort(std::vector{ ar }, begin(res), std::identity{}, std::identity{},
+                       tt::byte_radix_traits<std::uint32_t>{}, timings);
+        CHECK_EQ(4, timings.passes.size());
+        CHECK_EQ(8 * bytes, timings.total(tt::sort_phase::histogram).bytes);
+        CHECK(timings.total(tt::sort_phase::scatter).time <=
+              timings.total(std::size_t{ 0 }) + timings.total(std::size_t{ 1 }) +
+                  timings.total(std::size_t{ 2 }) + timings.total(std::size_t{ 3 }));
+
+        timings.clear();
+        CHECK(timings.passes.empty());
+    }
 }
@@ -0,0 +1,170 @@
+#include <doctest/doctest.h>
+
+#include <tt/spsc_ringbuf.hpp>
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// throws from copy ctor, when `copies_left` reaches zero
+struct throwing_copy
+{
+    static inline int live{ 0 };
+    static inline int copies_left{ 0 };
+
+    explicit throwing_copy(int v)
+        : value{ v }
+    {
+        ++live;
+    }
+
+    throwing_copy(throwing_copy const& other)
+        : value{ other.value }
+    {
+        if (copies_left-- == 0) throw std::runtime_error{ "copy" };
+        ++live;
+    }
+
+    throwing_copy(throwing_copy&& other) noexcept
+        : value{ other.value }
+    {
+        ++live;
+    }
+
+    ~throwing_copy()
+    {
+        --live;
+    }
+
+    int value;
+};
+
+} // namespace
+
+TEST_SUITE("spsc_ringbuf")
+{
+    TEST_CASE("try_push/pop_front")
+    {
+        tt::spsc_ringbuf<int> buf{ 2 };
+        REQUIRE(buf.empty());
+        REQUIRE(buf.try_push(1));
+        REQUIRE(buf.try_push(2));
+        REQUIRE(buf.full());
+        REQUIRE(!buf.try_push(3));
+
+        REQUIRE_EQ(1, buf.pop_front());
+        REQUIRE(buf.try_push(4));
+        REQUIRE_EQ(2, buf.pop_front());
+        REQUIRE_EQ(4, buf.pop_front());
+        REQUIRE(!buf.pop_front());
+    }
+
+    TEST_CASE("move-only type")
+    {
+        tt::spsc_ringbuf<std::unique_ptr<int>> buf{ 4 };
+        REQUIRE(buf.try_emplace_back(std::make_unique<int>(42)));
+        auto const v{ buf.pop_front() };
+        REQUIRE(v.has_value());
+        REQUIRE_EQ(42, **v);
+    }
+
+    TEST_CASE("push_n/pop_n across the end")
+    {
+        tt::spsc_ringbuf<int> buf{ 4 };
+        std::array const values{ 1, 2, 3, 4, 5, 6 };
+
+        REQUIRE_EQ(3, buf.push_n(std::span{ values }.first(3)));
+        REQUIRE_EQ(1, buf.pop_front());
+        REQUIRE_EQ(2, buf.push_n(std::span{ values }.subspan(3)));
+        REQUIRE(buf.full());
+
+        std::array<int, 8> out{};
+        REQUIRE_EQ(4, buf.pop_n(out));
+        std::array const expected{ 2, 3, 4, 5, 0, 0, 0, 0 };
+        REQUIRE_EQ(expected, out);
+        REQUIRE_EQ(0, buf.pop_n(out));
+    }
+
+    TEST_CASE("push_n uses allocator")
+    {
+        std::array<std::byte, 4096> storage;
+        std::pmr::monotonic_buffer_resource resource{ storage.data(), storage.size() };
+        tt::pmr::spsc_ringbuf<std::pmr::string> buf{ 4, &resource };
+
+        // long enough to be allocated, not in small string buffer
+        std::array<std::pmr::string, 2> const values{ std::pmr::string(64, 'a'),
+                                                      std::pmr::string(64, 'b') };
+        REQUIRE_EQ(2, buf.push_n(values));
+
+        auto const v{ buf.pop_front() };
+        REQUIRE(v);
+        REQUIRE_EQ(values[0], *v);
+        REQUIRE_EQ(&resource, v->get_allocator().resource());
+    }
+
+    TEST_CASE("push_n is exception safe across the end")
+    {
+        {
+            tt::spsc_ringbuf<throwing_copy> buf{ 4 };
+            for (int i{ 0 }; i < 3; ++i) REQUIRE(buf.try_emplace_back(i));
+            for (int i{ 0 }; i < 3; ++i) REQUIRE(buf.pop_front());
+
+            // 1 element before the end, the rest after it, copy of 3rd throws
+            std::array const values{ throwing_copy{ 10 }, throwing_copy{ 11 },
+                                     throwing_copy{ 12 } };
+            throwing_copy::copies_left = 2;
+            REQUIRE_THROWS(buf.push_n(values));
+
+            REQUIRE_EQ(2, buf.size());
+            REQUIRE_EQ(10, buf.pop_front()->value);
+            REQUIRE_EQ(11, buf.pop_front()->value);
+            REQUIRE(buf.empty());
+            REQUIRE_EQ(3, throwing_copy::live);
+        }
+        REQUIRE_EQ(0, throwing_copy::live);
+    }
+
+    TEST_CASE("produce/consume")
+    {
+        tt::spsc_ringbuf<int> buf{ 1024 };
+        int const tasks_count{ 100000 };
+
+        std::thread producer{ [&]
+                              {
+                                  std::array<int, 5> batch;
+                                  for (int i{ 0 }; i < tasks_count;)
+                                  {
+                                      if (i % 3 == 0)
+                                      {
+                                          if (buf.try_push(i)) ++i;
+                                          continue;
+                                      }
+                                      int const n{ std::min<int>(batch.size(), tasks_count - i) };
+                                      std::iota(batch.begin(), batch.begin() + n, i);
+                                      i += buf.push_n(std::span{ batch }.first(n));
+                                  }
+                              } };
+
+        std::vector<int> consumed;
+        std::array<int, 3> batch;
+        while (consumed.size() < tasks_count)
+        {
+            auto const n{ buf.pop_n(batch) };
+            consumed.insert(consumed.end(), batch.begin(), batch.begin() + n);
+            if (auto const v{ buf.pop_front() }) consumed.push_back(*v);
+        }
+        producer.join();
+
+        std::vector<int> expected(tasks_count);
+        std::iota(expected.begin(), expected.end(), 0);
+        REQUIRE_EQ(expected, consumed);
+    }
+}
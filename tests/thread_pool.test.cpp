@@ -0,0 +1,77 @@
+#include <doctest/doctest.h>
+
+#include <tt/thread_pool.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+
+long
+fib(tt::thread_pool& pool, int n)
+{
+    if (n < 2) return n;
+
+    long a{ 0 };
+    long b{ 0 };
+    pool.parallel_invoke([&] { a = fib(pool, n - 1); }, [&] { b = fib(pool, n - 2); });
+    return a + b;
+}
+
+} // namespace
+
+TEST_SUITE("thread_pool")
+{
+    TEST_CASE("submit/wait")
+    {
+        tt::thread_pool pool{ 3 };
+        REQUIRE_EQ(3, pool.threads_count());
+
+        std::atomic<int> sum{ 0 };
+        for (int i{ 0 }; i < 1000; ++i) pool.submit([&sum, i] { sum.fetch_add(i); });
+        pool.wait();
+        REQUIRE_EQ(1000 * 999 / 2, sum.load());
+    }
+
+    TEST_CASE("submit from task")
+    {
+        tt::thread_pool pool{ 2 };
+
+        std::atomic<int> count{ 0 };
+        for (int i{ 0 }; i < 10; ++i)
+        {
+            pool.submit(
+                [&]
+                {
+                    for (int j{ 0 }; j < 10; ++j) pool.submit([&] { count.fetch_add(1); });
+                });
+        }
+        pool.wait();
+        REQUIRE_EQ(100, count.load());
+    }
+
+    TEST_CASE("parallel_invoke")
+    {
+        tt::thread_pool pool{ 4 };
+        REQUIRE_EQ(6765, fib(pool, 20));
+
+        // from worker thread too
+        std::atomic<long> result{ 0 };
+        pool.submit([&] { result = fib(pool, 15); });
+        pool.wait();
+        REQUIRE_EQ(610, result.load());
+    }
+
+    TEST_CASE("parallel_for_each")
+    {
+        tt::thread_pool pool{ 4 };
+
+        std::vector<int> v(10000);
+        std::iota(v.begin(), v.end(), 0);
+        pool.parallel_for_each(v.begin(), v.end(), [](int& x) { x *= 2; }, 64);
+
+        for (int i{ 0 }; i < 10000; ++i) REQUIRE_EQ(2 * i, v[i]);
+    }
+}
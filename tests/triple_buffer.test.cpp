@@ -0,0 +1,89 @@
+#include <doctest/doctest.h>
+
+#include <tt/triple_buffer.hpp>
+
+#include <array>
+#include <cstdint>
+#include <thread>
+
+TEST_SUITE("triple_buffer")
+{
+    TEST_CASE("initial value")
+    {
+        tt::triple_buffer<int> box{ 42 };
+        REQUIRE_FALSE(box.has_new());
+        REQUIRE_FALSE(box.update());
+        REQUIRE_EQ(42, box.front());
+        REQUIRE_EQ(42, box.back());
+    }
+
+    TEST_CASE("reader gets the newest snapshot")
+    {
+        tt::triple_buffer<int> box;
+
+        box.write(1);
+        REQUIRE(box.has_new());
+        box.write(2);
+        box.write(3);
+
+        REQUIRE(box.update());
+        REQUIRE_EQ(3, box.front());
+        REQUIRE_FALSE(box.update());
+        REQUIRE_EQ(3, box.read());
+
+        box.write(4);
+        REQUIRE_EQ(4, box.read());
+    }
+
+    TEST_CASE("writer and reader never share buffer")
+    {
+        tt::triple_buffer<int> box;
+
+        for (int i{ 0 }; i < 10; ++i)
+        {
+            box.back() = i;
+            box.publish();
+            if (i % 3 == 0) (void)box.update();
+            REQUIRE_NE(&box.back(), &box.front());
+        }
+    }
+
+    TEST_CASE("snapshots are not torn")
+    {
+        struct snapshot
+        {
+            std::uint64_t seq{ 0 };
+            std::array<std::uint64_t, 15> payload{};
+        };
+
+        tt::triple_buffer<snapshot> box;
+        constexpr std::uint64_t count{ 100'000 };
+
+        std::jthread writer{ [&]
+                             {
+                                 for (std::uint64_t i{ 1 }; i <= count; ++i)
+                                 {
+                                     snapshot& s{ box.back() };
+                                     s.seq = i;
+                                     s.payload.fill(i);
+                                     box.publish();
+                                 }
+                             } };
+
+        std::uint64_t last{ 0 };
+        bool consistent{ true };
+        bool monotonic{ true };
+        while (last != count)
+        {
+            if (!box.update()) continue;
+
+            snapshot const& s{ box.front() };
+            for (std::uint64_t v : s.payload) consistent = consistent && v == s.seq;
+            monotonic = monotonic && s.seq > last;
+            last = s.seq;
+        }
+
+        REQUIRE(consistent);
+        REQUIRE(monotonic);
+    }
+}
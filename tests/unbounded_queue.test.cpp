@@ -0,0 +1,155 @@
+#include <doctest/doctest.h>
+
+#include <tt/unbounded_queue.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+std::size_t allocations_count{ 0 };
+
+template <typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <typename U>
+    counting_allocator(counting_allocator<U> const&)
+    {
+    }
+
+    T*
+    allocate(std::size_t n)
+    {
+        ++allocations_count;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void
+    deallocate(T* p, std::size_t n)
+    {
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    friend bool operator==(counting_allocator const&, counting_allocator const&) = default;
+};
+
+} // namespace
+
+TEST_SUITE("unbounded_queue")
+{
+    TEST_CASE("push_back/pop_front")
+    {
+        tt::unbounded_queue<int> queue;
+        REQUIRE(!queue.pop_front());
+
+        queue.push_back(42);
+        REQUIRE_EQ(42, queue.pop_front());
+        REQUIRE(!queue.pop_front());
+    }
+
+    TEST_CASE("fifo over several segments")
+    {
+        tt::unbounded_queue<int, std::allocator<int>, 4> queue;
+
+        for (int i{ 0 }; i < 100; ++i) queue.push_back(i);
+        for (int i{ 0 }; i < 100; ++i) REQUIRE_EQ(i, queue.pop_front());
+        REQUIRE(!queue.pop_front());
+
+        // after drain queue still works
+        queue.push_back(1);
+        REQUIRE_EQ(1, queue.pop_front());
+    }
+
+    TEST_CASE("move-only element")
+    {
+        tt::unbounded_queue<std::unique_ptr<int>, std::allocator<std::unique_ptr<int>>, 2> queue;
+        for (int i{ 0 }; i < 5; ++i) queue.push_back(std::make_unique<int>(i));
+
+        REQUIRE_EQ(0, **queue.pop_front());
+        REQUIRE_EQ(1, **queue.pop_front());
+    }
+
+    TEST_CASE("dtor destroys the rest")
+    {
+        auto const counter{ std::make_shared<int>() };
+        {
+            tt::unbounded_queue<std::shared_ptr<int>, std::allocator<std::shared_ptr<int>>, 4>
+                queue;
+            for (int i{ 0 }; i < 10; ++i) queue.push_back(counter);
+            (void)queue.pop_front();
+            REQUIRE_EQ(10, counter.use_count());
+        }
+        REQUIRE_EQ(1, counter.use_count());
+    }
+
+    TEST_CASE("segments are recycled")
+    {
+        tt::unbounded_queue<std::string, counting_allocator<std::string>, 4> queue;
+
+        auto const round{ [&]
+                          {
+                              for (int i{ 0 }; i < 64; ++i)
+                              {
+                                  queue.push_back("x");
+                                  REQUIRE_EQ("x", queue.pop_front());
+                              }
+                          } };
+
+        // warm up freelist and lists of hazard records
+        round();
+        round();
+        std::size_t const allocated{ allocations_count };
+
+        round();
+        REQUIRE_EQ(allocated, allocations_count);
+    }
+
+    TEST_CASE("produce/consume")
+    {
+        tt::unbounded_queue<int, std::allocator<int>, 16> queue;
+
+        int const tasks_count{ 20000 };
+        int const threads_count{ 3 };
+        std::atomic<int> consumed_count{ 0 };
+        std::atomic<long> consumed_sum{ 0 };
+
+        std::vector<std::thread> threads;
+        for (int t{ 0 }; t < threads_count; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    for (int i{ t }; i < tasks_count; i += threads_count) queue.push_back(i);
+                });
+            threads.emplace_back(
+                [&]
+                {
+                    while (consumed_count.load() < tasks_count)
+                    {
+                        if (auto const v{ queue.pop_front() })
+                        {
+                            consumed_sum.fetch_add(*v);
+                            consumed_count.fetch_add(1);
+                        } else
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+        }
+        std::ranges::for_each(threads, [](auto& t) { t.join(); });
+
+        REQUIRE(!queue.pop_front());
+        REQUIRE_EQ(tasks_count, consumed_count.load());
+        REQUIRE_EQ(long{ tasks_count } * (tasks_count - 1) / 2, consumed_sum.load());
+    }
+}
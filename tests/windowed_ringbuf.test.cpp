@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+
+#include <tt/windowed_ringbuf.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <numeric>
+
+TEST_SUITE("windowed_ringbuf")
+{
+    TEST_CASE("empty")
+    {
+        tt::windowed_ringbuf<int, tt::window::sum, tt::window::mean> buf{ 3 };
+        REQUIRE(buf.empty());
+        REQUIRE_EQ(0, buf.aggregate<tt::window::sum>());
+        REQUIRE_EQ(0., buf.aggregate<tt::window::mean>());
+    }
+
+    TEST_CASE("push_back with overwrite")
+    {
+        tt::windowed_ringbuf<int, tt::window::sum, tt::window::min, tt::window::max> buf{ 3 };
+        buf.push_back(5);
+        buf.push_back(1);
+        buf.push_back(3);
+        REQUIRE(buf.full());
+        REQUIRE_EQ(9, buf.aggregate<tt::window::sum>());
+        REQUIRE_EQ(1, buf.aggregate<tt::window::min>());
+        REQUIRE_EQ(5, buf.aggregate<tt::window::max>());
+
+        buf.push_back(2);
+        REQUIRE_EQ(6, buf.aggregate<tt::window::sum>());
+        REQUIRE_EQ(1, buf.aggregate<tt::window::min>());
+        REQUIRE_EQ(3, buf.aggregate<tt::window::max>());
+
+        buf.push_back(2);
+        REQUIRE_EQ(2, buf.aggregate<tt::window::min>());
+        REQUIRE(std::ranges::equal(buf, std::array{ 3, 2, 2 }));
+    }
+
+    TEST_CASE("pop_front/clear")
+    {
+        tt::windowed_ringbuf<int, tt::window::mean, tt::window::max> buf{ 4 };
+        buf.push_back(4);
+        buf.push_back(2);
+        buf.push_back(3);
+        REQUIRE_EQ(3., buf.aggregate<tt::window::mean>());
+
+        buf.pop_front();
+        REQUIRE_EQ(2.5, buf.aggregate<tt::window::mean>());
+        REQUIRE_EQ(3, buf.aggregate<tt::window::max>());
+
+        buf.clear();
+        REQUIRE(buf.empty());
+        buf.push_back(1);
+        REQUIRE_EQ(1., buf.aggregate<tt::window::mean>());
+        REQUIRE_EQ(1, buf.aggregate<tt::window::max>());
+    }
+
+    TEST_CASE("same as rescan of window")
+    {
+        std::size_t const capacity{ 16 };
+        tt::windowed_ringbuf<int, tt::window::sum, tt::window::min, tt::window::max> buf{
+            capacity
+        };
+
+        for (int i{ 0 }; i < 1000; ++i)
+        {
+            buf.push_back(std::rand() % 100);
+            REQUIRE_EQ(std::accumulate(buf.begin(), buf.end(), 0),
+                       buf.aggregate<tt::window::sum>());
+            REQUIRE_EQ(*std::ranges::min_element(buf), buf.aggregate<tt::window::min>());
+            REQUIRE_EQ(*std::ranges::max_element(buf), buf.aggregate<tt::window::max>());
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+
+#include <tt/work_stealing_deque.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_SUITE("work_stealing_deque")
+{
+    TEST_CASE("owner pops lifo, thief steals fifo")
+    {
+        tt::work_stealing_deque<int> deque{ 4 };
+        REQUIRE(deque.empty());
+        REQUIRE(!deque.pop());
+        REQUIRE(!deque.steal());
+
+        for (int i{ 0 }; i < 3; ++i) deque.push(i);
+        REQUIRE_EQ(3, deque.size());
+
+        REQUIRE_EQ(2, deque.pop());
+        REQUIRE_EQ(0, deque.steal());
+        REQUIRE_EQ(1, deque.pop());
+        REQUIRE(!deque.pop());
+        REQUIRE(!deque.steal());
+    }
+
+    TEST_CASE("grow")
+    {
+        tt::work_stealing_deque<int> deque{ 2 };
+        for (int i{ 0 }; i < 100; ++i) deque.push(i);
+        REQUIRE_EQ(100, deque.size());
+
+        for (int i{ 0 }; i < 50; ++i) REQUIRE_EQ(i, deque.steal());
+        for (int i{ 99 }; i >= 50; --i) REQUIRE_EQ(i, deque.pop());
+        REQUIRE(deque.empty());
+    }
+
+    TEST_CASE("owner and thieves take each element once")
+    {
+        tt::work_stealing_deque<int> deque{ 16 };
+
+        int const tasks_count{ 50000 };
+        std::atomic<int> taken_count{ 0 };
+        std::atomic<long> taken_sum{ 0 };
+        auto const take{ [&](std::optional<int> v)
+                         {
+                             if (!v) return;
+                             taken_sum.fetch_add(*v);
+                             taken_count.fetch_add(1);
+                         } };
+
+        std::vector<std::thread> thieves;
+        for (int t{ 0 }; t < 2; ++t)
+        {
+            thieves.emplace_back(
+                [&]
+                {
+                    while (taken_count.load() < tasks_count)
+                    {
+                        take(deque.steal());
+                        std::this_thread::yield();
+                    }
+                });
+        }
+
+        for (int i{ 0 }; i < tasks_count; ++i)
+        {
+            deque.push(i);
+            if (i % 3 == 0) take(deque.pop());
+        }
+        while (taken_count.load() < tasks_count) take(deque.pop());
+        std::ranges::for_each(thieves, [](auto& t) { t.join(); });
+
+        REQUIRE(deque.empty());
+        REQUIRE_EQ(tasks_count, taken_count.load());
+        REQUIRE_EQ(long{ tasks_count } * (tasks_count - 1) / 2, taken_sum.load());
+    }
+}